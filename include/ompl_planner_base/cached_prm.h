@@ -0,0 +1,103 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#ifndef OMPL_PLANNER_BASE_CACHED_PRM_H
+#define OMPL_PLANNER_BASE_CACHED_PRM_H
+
+// ompl planner specific classes
+#include <ompl/geometric/planners/prm/PRM.h>
+
+// std c++ classes
+#include <vector>
+
+
+namespace ompl_planner_base{
+
+/**
+ * @class CachedPRM
+ * @brief PRM whose roadmap is kept between planning queries and only re-validated where the costmap changed
+ *
+ * Vertices that became invalid are disconnected and taken out of the nearest neighbor structure and the roadmap
+ * expansion (the graph keeps them, so vertex descriptors stay valid), they are put back once a later invalidation
+ * of their region finds them valid again. Edges that became invalid are removed.
+ */
+class CachedPRM : public ompl::geometric::PRM {
+
+public:
+  /**
+     * @brief  Constructor for the cached PRM
+     * @param  si The space information to plan in (SE2)
+     */
+  CachedPRM(const ompl::base::SpaceInformationPtr& si);
+
+  /**
+     * @brief Re-validates all vertices and edges of the roadmap touching the given region of the plane
+     * @param min_x, min_y, max_x, max_y Region (in world coordinates) to re-validate
+     * @return Number of edges removed from the roadmap
+     */
+  unsigned int invalidateRegion(double min_x, double min_y, double max_x, double max_y);
+
+  /**
+     * @brief Adds the vertices and edges of a stored roadmap to the roadmap of the planner (planner has to be set up)
+     * @param data Roadmap as exported by getPlannerData (e.g. loaded with ompl::base::PlannerDataStorage)
+     * @return Number of vertices added to the roadmap
+     */
+  unsigned int loadRoadmap(const ompl::base::PlannerData& data);
+
+  virtual void clear();
+
+private:
+  /**
+     * @brief Disconnects an invalid vertex and hides it from the PRM (called with the graph lock held)
+     */
+  void detachVertex(Vertex v);
+
+  /**
+     * @brief Makes a detached vertex that is valid again available for connections (called with the graph lock held)
+     */
+  void attachVertex(Vertex v);
+
+  /**
+     * @brief Recomputes the connected components of the roadmap after edges have been removed
+     */
+  void rebuildComponents();
+
+  std::vector<Vertex> detached_vertices_; ///< @brief vertices taken out of the nearest neighbor structure
+};
+}
+
+#endif
@@ -0,0 +1,101 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#ifndef OMPL_PLANNER_BASE_COARSE_GRID_PLANNER_H
+#define OMPL_PLANNER_BASE_COARSE_GRID_PLANNER_H
+
+#include <ompl_planner_base/costmap_view.h>
+#include <ompl_planner_base/corridor_state_sampler.h>
+
+// std c++ classes
+#include <vector>
+
+
+namespace ompl_planner_base{
+
+/**
+ * @class CoarseGridPlanner
+ * @brief A* search for the robot center on a max-pooled downsampled copy of the costmap
+ *
+ * A coarse cell is blocked if any of the cells it covers is lethal or within the inscribed radius of an obstacle,
+ * so narrow passages may be closed on the coarse grid. The path found is only used to derive a corridor
+ * the full resolution planner samples in, not as plan.
+ */
+class CoarseGridPlanner {
+
+public:
+  /**
+     * @brief  Constructor for an empty grid
+     */
+  CoarseGridPlanner();
+
+  /**
+     * @brief Downsamples the costmap
+     * @param costmap The costmap to downsample
+     * @param factor Number of cells of the costmap per coarse cell (in each direction)
+     */
+  void update(const CostmapView& costmap, unsigned int factor);
+
+  /**
+     * @brief Searches a path of coarse cells between two positions (the cells of start and goal are treated as free)
+     * @param path Indices of the coarse cells from start to goal
+     * @return false if start or goal lie outside the grid or there is no path
+     */
+  bool plan(double start_x, double start_y, double goal_x, double goal_y, std::vector<unsigned int>& path);
+
+  /**
+     * @brief Fills the corridor with all coarse cells within a distance of the path
+     * @param width Distance from the path up to which cells belong to the corridor (in meters)
+     */
+  void getCorridor(const std::vector<unsigned int>& path, double width, Corridor& corridor);
+
+private:
+  bool worldToGrid(double wx, double wy, unsigned int& gx, unsigned int& gy) const;
+
+  std::vector<unsigned char> blocked_;
+  unsigned int size_x_, size_y_;
+  double resolution_, origin_x_, origin_y_;
+
+  // buffers of the search, reused between queries (cells are only valid if their stamp matches the current search)
+  std::vector<float> cost_;
+  std::vector<unsigned int> parent_;
+  std::vector<unsigned int> stamp_;
+  unsigned int current_stamp_;
+};
+}
+
+#endif
@@ -0,0 +1,125 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#ifndef OMPL_PLANNER_BASE_CONNECTIVITY_INDEX_H
+#define OMPL_PLANNER_BASE_CONNECTIVITY_INDEX_H
+
+#include <ompl_planner_base/costmap_view.h>
+#include <costmap_2d/cost_values.h>
+
+// std c++ classes
+#include <vector>
+
+
+namespace ompl_planner_base{
+
+/**
+ * @class ConnectivityIndex
+ * @brief Connected components of the cells the robot center may occupy, to reject unreachable goals before planning
+ *
+ * A cell is free unless it is lethal or within the inscribed radius of an obstacle (unknown cells count as free).
+ * Free cells are joined with their 8 neighbours by union-find, so two cells are connected if their roots are the same.
+ * Cells which became free are merged into the components incrementally. As union-find cannot split components,
+ * the components touching a region with cells which became blocked are relabeled by a flood fill.
+ * Queries compress paths and are therefore not const -> only to be used by one thread at a time.
+ */
+class ConnectivityIndex {
+
+public:
+  /**
+     * @brief  Constructor for an empty index
+     */
+  ConnectivityIndex();
+
+  /**
+     * @brief Labels all cells of the costmap
+     */
+  void build(const CostmapView& costmap);
+
+  /**
+     * @brief Updates the labels for the cells changed inside a region (in cells, inclusive)
+     * @param costmap The costmap with the same geometry as the one the index has been built for
+     * @return false if the index had to be rebuilt (geometry changed), true if it could be updated locally
+     */
+  bool update(const CostmapView& costmap, unsigned int min_x, unsigned int min_y, unsigned int max_x, unsigned int max_y);
+
+  /**
+     * @brief Drops all labels
+     */
+  void reset();
+
+  /**
+     * @brief Returns true if the index has been built
+     */
+  bool isValid() const { return !parent_.empty(); }
+
+  /**
+     * @brief Checks whether the robot center may move from one cell to another
+     * @return false if both cells are free and lie in different components, true otherwise
+     *         (also if one of the cells is blocked or outside the map, as nothing can be concluded then)
+     */
+  bool connected(unsigned int start_x, unsigned int start_y, unsigned int goal_x, unsigned int goal_y);
+
+  /**
+     * @brief Returns the label of the component of a cell (only meaningful for free cells)
+     */
+  unsigned int getLabel(unsigned int mx, unsigned int my) { return find(my * size_x_ + mx); }
+
+  static inline bool isFreeCost(unsigned char cost)
+  {
+    return (cost != costmap_2d::LETHAL_OBSTACLE) && (cost != costmap_2d::INSCRIBED_INFLATED_OBSTACLE);
+  }
+
+private:
+  unsigned int find(unsigned int index);
+  void unite(unsigned int index_a, unsigned int index_b);
+  void uniteWithNeighbors(unsigned int mx, unsigned int my);
+
+  /**
+     * @brief Relabels the free cells connected to a region and its border (free_ of the region has to be up to date)
+     */
+  void relabelAround(unsigned int min_x, unsigned int min_y, unsigned int max_x, unsigned int max_y);
+
+  std::vector<unsigned int> parent_;
+  std::vector<unsigned char> free_;
+  std::vector<unsigned char> visited_; ///< @brief cells reached by the flood fill of relabelAround
+  std::vector<unsigned int> open_; ///< @brief cells reached by the flood fill, in the order they are expanded
+  unsigned int size_x_, size_y_;
+};
+}
+
+#endif
@@ -0,0 +1,108 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#ifndef OMPL_PLANNER_BASE_CORRIDOR_STATE_SAMPLER_H
+#define OMPL_PLANNER_BASE_CORRIDOR_STATE_SAMPLER_H
+
+// ompl planner specific classes
+#include <ompl/base/StateSampler.h>
+#include <ompl/base/StateSpace.h>
+
+// boost classes
+#include <boost/shared_ptr.hpp>
+
+// std c++ classes
+#include <vector>
+
+
+namespace ompl_planner_base{
+
+/**
+ * @brief Square cells the planner preferably samples in (set before solving, only read by the planner threads)
+ */
+struct Corridor
+{
+  std::vector<double> cells_x, cells_y; ///< @brief lower left corners of the cells
+  double cell_size;
+  double bias; ///< @brief fraction of the samples drawn from the corridor, the rest is drawn uniformly
+
+  Corridor() : cell_size(0.0), bias(0.0){}
+
+  void clear()
+  {
+    cells_x.clear();
+    cells_y.clear();
+  }
+
+  bool empty() const { return cells_x.empty(); }
+};
+
+typedef boost::shared_ptr<Corridor> CorridorPtr;
+
+
+/**
+ * @class CorridorStateSampler
+ * @brief SE2 state sampler drawing uniform samples from the cells of a corridor (with random yaw)
+ *
+ * A fraction of 1 - bias of the samples, and all samples while the corridor is empty, are drawn by the default
+ * sampler of the state space, so the planner stays probabilistically complete. Samples near a state are always
+ * drawn by the default sampler.
+ */
+class CorridorStateSampler : public ompl::base::StateSampler {
+
+public:
+  CorridorStateSampler(const ompl::base::StateSpace* space, const CorridorPtr& corridor);
+
+  virtual void sampleUniform(ompl::base::State* state);
+
+  virtual void sampleUniformNear(ompl::base::State* state, const ompl::base::State* near, double distance);
+
+  virtual void sampleGaussian(ompl::base::State* state, const ompl::base::State* mean, double std_dev);
+
+private:
+  CorridorPtr corridor_;
+  ompl::base::StateSamplerPtr default_sampler_;
+};
+
+
+/**
+ * @brief Allocator for the state space (bind the corridor to get a ompl::base::StateSamplerAllocator)
+ */
+ompl::base::StateSamplerPtr allocCorridorStateSampler(const ompl::base::StateSpace* space, const CorridorPtr& corridor);
+}
+
+#endif
@@ -0,0 +1,110 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#ifndef OMPL_PLANNER_BASE_COSTMAP_CHANGE_TRACKER_H
+#define OMPL_PLANNER_BASE_COSTMAP_CHANGE_TRACKER_H
+
+#include <ompl_planner_base/costmap_view.h>
+#include <costmap_2d/costmap_2d.h>
+
+// std c++ classes
+#include <vector>
+
+
+namespace ompl_planner_base{
+
+/**
+ * @class CostmapChangeTracker
+ * @brief Keeps a copy of the costmap to determine which region of the map changed between two planning queries
+ *
+ * The costmap only reports the bounds of its last update cycle. As several update cycles may pass between two
+ * planning queries, the tracker compares against its own copy instead (row-wise, rows without changes are skipped with memcmp).
+ */
+class CostmapChangeTracker {
+
+public:
+  /**
+     * @brief  Constructor for a tracker without reference copy
+     */
+  CostmapChangeTracker();
+
+  /**
+     * @brief Compares the costmap against the copy taken on the last call and takes a new copy
+     * @param costmap The costmap to track (locked while it is read)
+     * @return false if there was no comparable copy (first call, map resized or moved), true otherwise
+     */
+  bool update(costmap_2d::Costmap2D& costmap);
+
+  /**
+     * @brief Same as above for a view (e.g. onto a snapshot the planner works on), which is not locked
+     */
+  bool update(const CostmapView& costmap);
+
+  /**
+     * @brief Returns true if cells changed between the last two calls to update
+     */
+  bool hasChanged() const { return changed_; }
+
+  /**
+     * @brief Returns the bounds (in cells, inclusive) of the region changed between the last two calls to update
+     */
+  void getChangedBounds(unsigned int& min_x, unsigned int& min_y, unsigned int& max_x, unsigned int& max_y) const;
+
+  /**
+     * @brief Returns a view onto the copy taken on the last update (the changes have been determined against)
+     */
+  CostmapView getReferenceView() const
+  {
+    return reference_.empty() ? CostmapView() : CostmapView(&reference_[0], size_x_, size_y_, resolution_, origin_x_, origin_y_);
+  }
+
+  /**
+     * @brief Drops the reference copy -> next update is not comparable
+     */
+  void reset();
+
+private:
+  std::vector<unsigned char> reference_; ///< @brief copy of the char map taken on the last update
+  unsigned int size_x_, size_y_;
+  double resolution_, origin_x_, origin_y_;
+
+  bool changed_;
+  unsigned int min_x_, min_y_, max_x_, max_y_;
+};
+}
+
+#endif
@@ -0,0 +1,114 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#ifndef OMPL_PLANNER_BASE_COSTMAP_MOTION_VALIDATOR_H
+#define OMPL_PLANNER_BASE_COSTMAP_MOTION_VALIDATOR_H
+
+#include <ompl_planner_base/costmap_view.h>
+#include <ompl_planner_base/footprint_lookup_table.h>
+
+// ompl planner specific classes
+#include <ompl/base/MotionValidator.h>
+#include <ompl/base/SpaceInformation.h>
+
+// std c++ classes
+#include <utility>
+
+
+namespace ompl_planner_base{
+
+/**
+ * @class CostmapMotionValidator
+ * @brief Motion validator for SE2 which steps along a motion at the resolution of the costmap
+ *
+ * Consecutive samples are chosen such that neither the robot center nor any point within the circumscribed radius
+ * moves by more than one cell. If footprint checks are done with a footprint lookup table, the checked cells only
+ * depend on the cell of the center and the yaw bin, so samples with the same cell and yaw bin as the previous one are skipped.
+ * The validity of the states is checked with the state validity checker of the space information.
+ */
+class CostmapMotionValidator : public ompl::base::MotionValidator {
+
+public:
+  /**
+     * @brief  Constructor for the motion validator
+     * @param  si The space information (SE2) the motions are checked in
+     */
+  CostmapMotionValidator(ompl::base::SpaceInformation* si);
+
+  /**
+     * @brief Sets the costmap geometry to step on (must not be called while planning)
+     * @param costmap View onto the costmap the validity checker works on
+     * @param circumscribed_radius Circumscribed radius of the footprint (determines steps for rotations)
+     * @param lookup_table Lookup table the validity checker works with, NULL if the polygon is checked (no samples are skipped then)
+     */
+  void setCostmap(const CostmapView& costmap, double circumscribed_radius, const FootprintLookupTable* lookup_table);
+
+  /**
+     * @brief Checks whether the motion from s1 to s2 is valid (s1 is assumed to be valid)
+     */
+  virtual bool checkMotion(const ompl::base::State* s1, const ompl::base::State* s2) const;
+
+  /**
+     * @brief Checks whether the motion from s1 to s2 is valid and reports the last valid state of the motion otherwise
+     */
+  virtual bool checkMotion(const ompl::base::State* s1, const ompl::base::State* s2,
+                           std::pair<ompl::base::State*, double>& last_valid) const;
+
+private:
+  /**
+     * @brief Number of steps needed to check the motion
+     */
+  unsigned int getStepCount(const ompl::base::State* s1, const ompl::base::State* s2) const;
+
+  /**
+     * @brief Key of the cells checked for a state (cell of the center and yaw bin)
+     * @return false if the state lies outside of the map
+     */
+  bool getCellKey(const ompl::base::State* state, unsigned int& cell_index, unsigned int& yaw_bin) const;
+
+  /**
+     * @brief Checks the interior samples of the motion, returns the index of the first invalid step or steps if all are valid
+     */
+  unsigned int checkSteps(const ompl::base::State* s1, const ompl::base::State* s2, unsigned int steps, ompl::base::State* work) const;
+
+  CostmapView costmap_;
+  double circumscribed_radius_;
+  const FootprintLookupTable* lookup_table_;
+};
+}
+
+#endif
@@ -0,0 +1,115 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#ifndef OMPL_PLANNER_BASE_COSTMAP_SNAPSHOT_H
+#define OMPL_PLANNER_BASE_COSTMAP_SNAPSHOT_H
+
+#include <ompl_planner_base/costmap_view.h>
+#include <costmap_2d/costmap_2d.h>
+
+// boost classes
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+// std c++ classes
+#include <stddef.h>
+
+
+namespace ompl_planner_base{
+
+/**
+ * @class CostmapSnapshot
+ * @brief Planner-owned copy of (a region of) the costmap which stays unchanged for the duration of a solve
+ *
+ * The cells are copied while holding the lock of the costmap, which is released right after the copy.
+ * The buffer is aligned to cache lines and kept for the next copy if it is large enough.
+ */
+class CostmapSnapshot : private boost::noncopyable {
+
+public:
+  /**
+     * @brief  Constructor for an empty snapshot
+     */
+  CostmapSnapshot();
+
+  /**
+     * @brief  Destructor, frees the buffer
+     */
+  ~CostmapSnapshot();
+
+  /**
+     * @brief Copies the whole costmap
+     * @param costmap The costmap to copy (locked while copying)
+     */
+  void copy(costmap_2d::Costmap2D& costmap);
+
+  /**
+     * @brief Copies a region of the costmap, the region is clipped to the map
+     * @param costmap The costmap to copy (locked while copying)
+     * @param min_x, min_y, max_x, max_y Region to copy in cells (inclusive)
+     */
+  void copy(costmap_2d::Costmap2D& costmap, unsigned int min_x, unsigned int min_y, unsigned int max_x, unsigned int max_y);
+
+  /**
+     * @brief Copies the cells of a view, e.g. onto a recorded costmap
+     */
+  void copy(const CostmapView& view);
+
+  /**
+     * @brief Returns a view onto the copied cells (valid until the next copy or destruction of the snapshot)
+     *        Cells outside the copied region are outside of the map of the view.
+     */
+  CostmapView getView() const;
+
+private:
+  static const size_t CACHE_LINE_SIZE = 64;
+
+  /**
+     * @brief Makes sure the buffer holds at least size bytes (contents are lost on reallocation)
+     */
+  void reserve(size_t size);
+
+  unsigned char* data_;
+  size_t capacity_; ///< @brief size of the allocated buffer in bytes
+  unsigned int size_x_, size_y_;
+  double resolution_, origin_x_, origin_y_;
+};
+
+typedef boost::shared_ptr<CostmapSnapshot> CostmapSnapshotPtr;
+}
+
+#endif
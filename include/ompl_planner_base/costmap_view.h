@@ -0,0 +1,121 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#ifndef OMPL_PLANNER_BASE_COSTMAP_VIEW_H
+#define OMPL_PLANNER_BASE_COSTMAP_VIEW_H
+
+#include <costmap_2d/costmap_2d.h>
+
+
+namespace ompl_planner_base{
+
+/**
+ * @class CostmapView
+ * @brief Read-only view onto the cells of a costmap
+ *
+ * The view only stores the geometry of the map and a pointer to the cells. All methods are const and do not touch
+ * any shared state, so the view can be used by several planner threads at once. Method names follow costmap_2d::Costmap2D.
+ */
+class CostmapView {
+
+public:
+  /**
+     * @brief  Constructor for an empty view
+     */
+  CostmapView()
+    : data_(NULL), size_x_(0), size_y_(0), resolution_(0.0), origin_x_(0.0), origin_y_(0.0){}
+
+  /**
+     * @brief  Constructor for a view onto the cells of a costmap (the costmap has to outlive the view)
+     */
+  explicit CostmapView(const costmap_2d::Costmap2D& costmap)
+    : data_(costmap.getCharMap()), size_x_(costmap.getSizeInCellsX()), size_y_(costmap.getSizeInCellsY()),
+      resolution_(costmap.getResolution()), origin_x_(costmap.getOriginX()), origin_y_(costmap.getOriginY()){}
+
+  /**
+     * @brief  Constructor for a view onto a buffer of cells stored row by row
+     */
+  CostmapView(const unsigned char* data, unsigned int size_x, unsigned int size_y,
+              double resolution, double origin_x, double origin_y)
+    : data_(data), size_x_(size_x), size_y_(size_y), resolution_(resolution), origin_x_(origin_x), origin_y_(origin_y){}
+
+  /**
+     * @brief Converts from world coordinates to map coordinates
+     * @return false if the point lies outside the map
+     */
+  inline bool worldToMap(double wx, double wy, unsigned int& mx, unsigned int& my) const
+  {
+    if( (wx < origin_x_) || (wy < origin_y_) )
+      return false;
+
+    mx = (unsigned int) ((wx - origin_x_) / resolution_);
+    my = (unsigned int) ((wy - origin_y_) / resolution_);
+
+    return (mx < size_x_) && (my < size_y_);
+  }
+
+  /**
+     * @brief Converts from map coordinates to world coordinates (center of cell)
+     */
+  inline void mapToWorld(unsigned int mx, unsigned int my, double& wx, double& wy) const
+  {
+    wx = origin_x_ + (mx + 0.5) * resolution_;
+    wy = origin_y_ + (my + 0.5) * resolution_;
+  }
+
+  inline unsigned int getIndex(unsigned int mx, unsigned int my) const { return my * size_x_ + mx; }
+  inline unsigned char getCost(unsigned int mx, unsigned int my) const { return data_[getIndex(mx, my)]; }
+  inline const unsigned char* getCharMap() const { return data_; }
+
+  inline unsigned int getSizeInCellsX() const { return size_x_; }
+  inline unsigned int getSizeInCellsY() const { return size_y_; }
+  inline double getSizeInMetersX() const { return size_x_ * resolution_; }
+  inline double getSizeInMetersY() const { return size_y_ * resolution_; }
+  inline double getResolution() const { return resolution_; }
+  inline double getOriginX() const { return origin_x_; }
+  inline double getOriginY() const { return origin_y_; }
+
+  inline bool isValid() const { return data_ != NULL; }
+
+private:
+  const unsigned char* data_;
+  unsigned int size_x_, size_y_;
+  double resolution_, origin_x_, origin_y_;
+};
+}
+
+#endif
@@ -0,0 +1,128 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#ifndef OMPL_PLANNER_BASE_FOOTPRINT_LOOKUP_TABLE_H
+#define OMPL_PLANNER_BASE_FOOTPRINT_LOOKUP_TABLE_H
+
+#include <ompl_planner_base/costmap_view.h>
+#include <geometry_msgs/Point.h>
+
+// std c++ classes
+#include <vector>
+
+
+namespace ompl_planner_base{
+
+/**
+ * @class FootprintLookupTable
+ * @brief Precomputed rasterization of the footprint outline for a fixed number of discretized orientations.
+ *
+ * The outline of the footprint is laid down into the grid once per yaw bin and stored as cell offsets
+ * relative to the cell of the robot center. A footprint check then only walks a flat array of offsets
+ * into the char map of the costmap instead of transforming and rasterizing the polygon per query.
+ * The cells of a yaw bin cover the union of the outlines the costmap model lays down for all orientations
+ * rounded to the bin and all positions of the robot center inside its cell (per edge the convex hull of the cells
+ * both corners can fall into, grown by half a cell). So the table is conservative
+ * (it never accepts a pose the costmap model rejects) and its result only depends on the cell and yaw bin.
+ * Once built, the table is only read and can be shared by several planner threads.
+ */
+class FootprintLookupTable {
+
+public:
+  /**
+     * @brief  Constructor for an empty (uninitialized) lookup table
+     */
+  FootprintLookupTable();
+
+  /**
+     * @brief Rasterizes the footprint outline for all yaw bins
+     * @param footprint The footprint specification of the robot (in the robot frame)
+     * @param resolution The resolution of the costmap the table is used with
+     * @param num_yaw_bins Number of discretized orientations over the full circle
+     * @return true if the table could be built, false otherwise (footprint with less than 3 points, invalid resolution)
+     */
+  bool initialize(const std::vector<geometry_msgs::Point>& footprint, double resolution, unsigned int num_yaw_bins);
+
+  /**
+     * @brief Checks whether the table has been built for the given footprint, resolution and number of yaw bins
+     */
+  bool matches(const std::vector<geometry_msgs::Point>& footprint, double resolution, unsigned int num_yaw_bins) const;
+
+  /**
+     * @brief Returns true once the table has been built
+     */
+  bool isInitialized() const { return initialized_; }
+
+  /**
+     * @brief Discretizes an orientation to the according yaw bin
+     */
+  unsigned int getYawBin(double theta) const;
+
+  /**
+     * @brief Returns the number of yaw bins of the table
+     */
+  unsigned int getNumYawBins() const { return num_yaw_bins_; }
+
+  /**
+     * @brief Checks the legality of the robot footprint at a position and orientation against the costmap
+     * @return -1.0 if the footprint leaves the map or covers a lethal or unknown cell, the maximum cost of the cells below the outline otherwise
+     */
+  double footprintCost(const CostmapView& costmap, double x, double y, double theta) const;
+
+private:
+  /**
+     * @brief Computes the range of cells (relative to the cell of the robot center) a corner of the footprint falls into
+     *        for all orientations of [yaw_min, yaw_max] and all positions of the center inside its cell
+     */
+  void getCornerCellRange(const geometry_msgs::Point& corner, double yaw_min, double yaw_max,
+                          int& min_x, int& max_x, int& min_y, int& max_y) const;
+
+  bool initialized_;
+  double resolution_;
+  unsigned int num_yaw_bins_;
+  std::vector<geometry_msgs::Point> footprint_; ///< @brief footprint the table has been built for
+
+  // flat arrays of cell offsets of all yaw bins, offsets of bin i are stored in [bin_begin_[i], bin_begin_[i+1])
+  std::vector<int> offsets_x_, offsets_y_;
+  std::vector<unsigned int> bin_begin_;
+
+  // extension of the rasterized outline per yaw bin (used to test once per query whether the footprint leaves the map)
+  std::vector<int> min_dx_, max_dx_, min_dy_, max_dy_;
+};
+}
+
+#endif
@@ -57,12 +57,33 @@
 #include <tf/transform_datatypes.h>
 #include <angles/angles.h>
 
-#include <base_local_planner/world_model.h>
-#include <base_local_planner/costmap_model.h>
+#include <base_local_planner/line_iterator.h>
 
 // ros sandbox classes
 #include <ompl_planner_base/OMPLPlannerBaseStats.h>
 #include <ompl_planner_base/OMPLPlannerDiagnostics.h>
+#include <ompl_planner_base/SaveRoadmap.h>
+#include <ompl_planner_base/DumpTrace.h>
+#include <ompl_planner_base/MakePlans.h>
+#include <ompl_planner_base/MakePlanToAnyGoal.h>
+#include <ompl_planner_base/OMPLPlannerBaseConfig.h>
+#include <dynamic_reconfigure/server.h>
+#include <ompl_planner_base/costmap_view.h>
+#include <ompl_planner_base/costmap_snapshot.h>
+#include <ompl_planner_base/footprint_lookup_table.h>
+#include <ompl_planner_base/validity_statistics.h>
+#include <ompl_planner_base/validity_cache.h>
+#include <ompl_planner_base/costmap_change_tracker.h>
+#include <ompl_planner_base/connectivity_index.h>
+#include <ompl_planner_base/coarse_grid_planner.h>
+#include <ompl_planner_base/corridor_state_sampler.h>
+#include <ompl_planner_base/cached_prm.h>
+#include <ompl_planner_base/costmap_motion_validator.h>
+#include <ompl_planner_base/swept_footprint_motion_validator.h>
+#include <ompl_planner_base/profiling_motion_validator.h>
+#include <ompl_planner_base/trace_buffer.h>
+#include <ompl_planner_base/request_recorder.h>
+#include <ompl_planner_base/pooled_state_space.h>
 
 // std c++ classes
 #include <math.h>
@@ -70,6 +91,10 @@
 
 // boost classes
 #include <boost/bind.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/atomic.hpp>
 
 // ompl planner specific classes
 #include <ompl/base/State.h>
@@ -82,11 +107,17 @@
 #include <ompl/base/spaces/RealVectorBounds.h>
 #include <ompl/geometric/SimpleSetup.h>
 #include <ompl/base/Path.h>
+#include <ompl/base/PlannerData.h>
+#include <ompl/base/PlannerDataStorage.h>
+#include <ompl/base/PlannerTerminationCondition.h>
+#include <ompl/base/goals/GoalStates.h>
 #include <ompl/geometric/PathGeometric.h>
+#include <ompl/geometric/PathSimplifier.h>
 // ompl planners
 #include <ompl/geometric/planners/est/EST.h>
 #include <ompl/geometric/planners/kpiece/KPIECE1.h>
 #include <ompl/geometric/planners/kpiece/LBKPIECE1.h>
+#include <ompl/geometric/planners/prm/PRM.h>
 #include <ompl/geometric/planners/rrt/LazyRRT.h>
 #include <ompl/geometric/planners/rrt/pRRT.h>
 #include <ompl/geometric/planners/rrt/RRT.h>
@@ -129,6 +160,20 @@ void convert(const geometry_msgs::Pose2D& pose2D, geometry_msgs::Pose &pose);
 
 
 
+/**
+ * @brief Result of one query of a batch
+ */
+struct BatchPlanResult
+{
+  bool solved;
+  double length; ///< @brief length of the (simplified) path in meters, 0 if not solved
+  double planning_time; ///< @brief time spent solving the query (without simplification)
+  std::vector<geometry_msgs::PoseStamped> plan; ///< @brief empty if only lengths are requested
+
+  BatchPlanResult() : solved(false), length(0.0), planning_time(0.0){}
+};
+
+
 /**
  * @class OMPLPlannerBase
  * @brief Plugin to the ros base_global_planner. Implements an interface to the Open Motion Planning Library OMPL
@@ -165,6 +210,46 @@ public:
   bool makePlan(const geometry_msgs::PoseStamped& start,
                 const geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& plan);
 
+  /**
+     * @brief Plans many queries on one costmap snapshot, sharing state space, validity cache and roadmap between them
+     * @param starts One start for all goals, or one start per goal
+     * @param goals The goal poses
+     * @param results Result per goal (in the same order)
+     * @param lengths_only True if only the lengths of the paths are needed (plans are not converted)
+     * @return False if the planner is not initialized or the queries are malformed, true otherwise (also if queries failed)
+     */
+  bool makePlans(const std::vector<geometry_msgs::PoseStamped>& starts, const std::vector<geometry_msgs::PoseStamped>& goals,
+                 std::vector<BatchPlanResult>& results, bool lengths_only = false);
+
+  /**
+     * @brief Plans one path from the start to whichever of several goals the planner reaches first
+     * @param start The start pose
+     * @param goals The candidate goal poses (candidates in collision or not connected to the start are dropped)
+     * @param plan The plan... filled by the planner
+     * @param goal_index Index of the goal the plan leads to, -1 if no plan was found
+     * @return True if a valid plan was found, false otherwise
+     */
+  bool makePlanToAnyGoal(const geometry_msgs::PoseStamped& start, const std::vector<geometry_msgs::PoseStamped>& goals,
+                         std::vector<geometry_msgs::PoseStamped>& plan, int& goal_index);
+
+  /**
+     * @brief Diagnostics published for the last call to makePlan (empty if none were published, e.g. with publish_diagnostics off)
+     *        Only to be called from the thread calling makePlan.
+     */
+  ompl_planner_base::OMPLPlannerDiagnostics::ConstPtr getLastDiagnostics() const { return last_diagnostics_; }
+
+  /**
+     * @brief Statistics published for the last call to makePlan (empty if none were published, e.g. if no path was found)
+     *        Only to be called from the thread calling makePlan.
+     */
+  ompl_planner_base::OMPLPlannerBaseStats::ConstPtr getLastStatistics() const { return last_statistics_; }
+
+  /**
+     * @brief Plans all following queries on the given snapshot instead of copying the costmap (e.g. one snapshot shared by several planners)
+     * @param snapshot Snapshot of the costmap of this planner, which is only read, or an empty pointer to copy the costmap again
+     */
+  void setCostmapSnapshot(const CostmapSnapshotPtr& snapshot);
+
   /**
      * @brief  Destructor for the PRM Planner
      */
@@ -172,12 +257,18 @@ public:
 
 
 private:
+  // microbenchmarks of the checks and conversions set up a planner without costmap_2d::Costmap2DROS (see microbenchmark_planner.cpp)
+  friend class PlannerBenchmarkAccess;
 
   ros::NodeHandle private_nh_;
   costmap_2d::Costmap2DROS* costmap_ros_;
   double step_size_, min_dist_from_robot_;
   costmap_2d::Costmap2D* costmap_;
-  base_local_planner::WorldModel* world_model_; ///< @brief The world model that the controller will use
+  CostmapView costmap_view_; ///< @brief read-only view onto the cells of the costmap used by the validity checker
+  bool use_costmap_snapshot_; ///<@brief parameter to flag whether planning is done on a copy of the costmap taken at the start of each query
+  bool planning_on_snapshot_; ///<@brief true if the current query plans on a snapshot (own or external) instead of the live costmap
+  CostmapSnapshotPtr costmap_snapshot_; ///<@brief copy of the costmap the current query is planned on
+  CostmapSnapshotPtr external_snapshot_; ///<@brief snapshot set from outside to plan on instead of own copies (empty -> costmap is copied)
 
   double inscribed_radius_, circumscribed_radius_, inflation_radius_;
   std::vector<geometry_msgs::Point> footprint_spec_; ///< @brief The footprint specification of the robot
@@ -192,30 +283,234 @@ private:
   double solver_; ///<@brief parameter to set density of pathframes for interpolation
   std::string planner_type_; ///<@brief parameter to switch between different planners provided through ompl
   double solver_maxtime_;
+  bool use_footprint_lookup_table_; ///<@brief parameter to flag whether footprint checks use the precomputed lookup table instead of the costmap model
+  int footprint_lookup_yaw_bins_; ///<@brief parameter to set number of discretized orientations of the footprint lookup table
+
+  FootprintLookupTable footprint_lookup_table_; ///<@brief rasterized footprint outline per yaw bin
+
+  bool use_tiered_validity_check_; ///<@brief parameter to flag whether the cost of the center cell is used to accept or reject states before the footprint check
+  unsigned char circumscribed_cost_; ///<@brief inflation cost at the fast accept distance (0 if unknown -> no fast accept)
+  unsigned int fast_accept_distance_; ///<@brief distance in cells from the center cell up to which the footprint check may look at cells
+  static const int FAST_ACCEPT_MARGIN_CELLS = 2;
+
+  // inputs circumscribed_cost_ has been computed from -> only recomputed if one of them changes
+  bool circumscribed_cost_current_;
+  double circumscribed_cost_radius_, circumscribed_cost_resolution_, circumscribed_cost_inflation_radius_;
+  std::string inflation_layer_name_;
+  ros::NodeHandle inflation_layer_nh_; ///<@brief handle of the inflation layer the inflation radius is read from (cached parameter)
+
+  // blocks of cells containing unknown cells (not inflated, but rejected by the footprint check), empty while not maintained
+  static const unsigned int UNKNOWN_BLOCK_SIZE = 16;
+  std::vector<unsigned char> unknown_blocks_;
+  unsigned int unknown_blocks_size_x_;
+
+  // counters for the tiers of the validity check (reset every planning query)
+  mutable ValidityStatistics validity_statistics_;
+
+  // memo of validity results per cell and yaw bin (requires the footprint lookup table)
+  bool use_validity_cache_; ///<@brief parameter to flag whether validity results are cached between states in the same cell and yaw bin
+  int validity_cache_max_megabytes_; ///<@brief parameter to set the memory the validity cache may use
+  mutable ValidityCache validity_cache_;
+  int validity_cache_max_footprint_cost_; ///<@brief max_footprint_cost the cached results have been computed with
+  bool validity_cache_tiered_; ///<@brief use_tiered_validity_check the cached results have been computed with
+
+  mutable boost::thread_specific_ptr<std::vector<unsigned int> > footprint_scratch_; ///<@brief cells of the footprint corners, one buffer per planner thread
+  int planner_threads_; ///<@brief parameter to set number of threads used by the parallel planners (pRRT, pSBL)
+
+  std::string motion_validation_mode_; ///<@brief parameter to select how motions are checked ("discrete" -> ompl default, "grid" -> steps at costmap resolution, "swept" -> swept area of the footprint)
+  boost::shared_ptr<CostmapMotionValidator> motion_validator_; ///<@brief handle to the motion validator of the simple setup if motions are checked on the grid
+  boost::shared_ptr<SweptFootprintMotionValidator> swept_motion_validator_; ///<@brief handle to the motion validator of the simple setup if swept areas are checked
+  boost::shared_ptr<ProfilingMotionValidator> profiling_motion_validator_; ///<@brief motion validator of the simple setup, counts the checks of the validators above
+  bool profile_collision_checks_; ///<@brief parameter to flag whether the time spent in validity and motion checks is measured
+
+  // events of the phases of the queries and of the planner threads
+  TraceBuffer trace_;
+  bool enable_tracing_; ///<@brief parameter to flag whether events are recorded to the trace buffer
+  bool trace_collision_checks_; ///<@brief parameter to flag whether every motion check is recorded (requires enable_tracing)
+
+  // requests recorded for replay
+  bool record_requests_; ///<@brief parameter to flag whether start, goal, parameters and costmap of every query are recorded
+  RequestRecorder recorder_;
+  RecordedRequest recorded_request_; ///<@brief parameters of the next record (formatted when they change)
+  std::string record_directory_; ///<@brief parameter to set directory of the record files
+  int record_file_megabytes_; ///<@brief parameter to set size of each record file
+  int record_file_count_; ///<@brief parameter to set number of record files, the oldest one is overwritten once all are full
+
+  // ompl objects kept alive between planning queries
+  bool persistent_setup_; ///<@brief parameter to flag whether state space, simple setup and planner are reused between queries
+  ompl::base::StateSpacePtr state_space_;
+  StatePoolPtr state_pool_; ///<@brief states of all state spaces of the planner, kept across queries (and rebuilds of the state space)
+  ompl::geometric::SimpleSetupPtr simple_setup_;
+
+  // configuration the current simple setup has been created for
+  ompl::base::RealVectorBounds setup_bounds_;
+  std::string setup_planner_type_;
+  double setup_validity_check_resolution_;
+  std::vector<geometry_msgs::Point> setup_footprint_;
+  bool setup_cache_roadmap_;
+  int setup_planner_threads_;
+  std::string setup_motion_validation_mode_;
+
+  // roadmap kept between planning queries
+  bool cache_roadmap_; ///<@brief parameter to flag whether the PRM roadmap is kept between queries (requires persistent_setup)
+  boost::shared_ptr<CachedPRM> cached_prm_; ///<@brief handle to the planner of the simple setup if it is a cached PRM
+  CostmapChangeTracker costmap_change_tracker_; ///<@brief determines region of the costmap changed since last query
+  std::string roadmap_directory_; ///<@brief parameter to set directory roadmaps are loaded from on startup and saved to (empty -> no preloading)
+
+  // free space components to reject unreachable goals before planning
+  bool use_connectivity_check_; ///<@brief parameter to flag whether goals outside the free region of the start are rejected
+  ConnectivityIndex connectivity_index_; ///<@brief labels of the free regions, updated from the changes found by the change tracker
+
+  // coarse stage of the coarse-to-fine mode
+  bool use_coarse_to_fine_; ///<@brief parameter to flag whether samples are drawn from a corridor around a path on a downsampled costmap
+  int coarse_downsampling_factor_; ///<@brief parameter to set number of costmap cells per coarse cell (in each direction)
+  double coarse_corridor_width_; ///<@brief parameter to set distance from the coarse path up to which cells belong to the corridor
+  double coarse_corridor_bias_; ///<@brief parameter to set fraction of the samples drawn from the corridor
+  CoarseGridPlanner coarse_grid_planner_;
+  CorridorPtr corridor_; ///<@brief corridor of the current query, shared with the state samplers of the state space
+
+  // region of interest the state space is restricted to
+  bool use_region_of_interest_; ///<@brief parameter to flag whether the state space only spans a box around start and goal instead of the whole map
+  double roi_margin_; ///<@brief parameter to set distance the box around start and goal is inflated by
+  double roi_relative_margin_; ///<@brief parameter to set additional inflation as fraction of the distance between start and goal
+  double roi_growth_factor_; ///<@brief parameter to set factor the inflation grows by after each attempt without a solution
+
+  boost::mutex planner_mutex_; ///<@brief protects the simple setup against concurrent access from planning and service calls
+
+  // planners raced against each other if global_planner_type lists several planners
+  std::vector<ompl::base::PlannerPtr> portfolio_planners_;
+  std::vector<std::string> portfolio_planner_types_;
+
+  /**
+     * @brief Result of a portfolio race shared by all planner threads
+     */
+  struct PortfolioRace
+  {
+    boost::mutex mutex;
+    boost::atomic<bool> done; ///< @brief set as soon as an exact solution has been found
+    bool exact;
+    double difference;
+    ompl::base::PathPtr path;
+    std::string winner;
+
+    bool isDone() const { return done; }
+  };
+
+  // last plan, reused while moving towards the same goal
+  bool reuse_last_plan_; ///<@brief parameter to flag whether the last plan is re-validated and reused if the goal did not change
+  double replan_goal_tolerance_; ///<@brief parameter to set distance up to which a goal is treated as unchanged
+  double replan_goal_yaw_tolerance_; ///<@brief parameter to set difference of orientation up to which a goal is treated as unchanged
+  double replan_start_tolerance_; ///<@brief parameter to set distance of the start from the last plan up to which the plan is reused
+  std::vector<geometry_msgs::Pose2D> last_path_; ///<@brief states of the last plan (before interpolation), empty if there is none
+  geometry_msgs::Pose2D last_goal_;
+
+  // simplification of the solution
+  double simplify_maxtime_; ///<@brief parameter to set maximum time for simplifying the solution (0 -> no limit)
+  bool use_grid_shortcuts_; ///<@brief parameter to flag whether the solution is simplified by shortcuts checked on the grid instead of ompl's path simplifier
+
+  // anytime planning -> plan is improved in the background after makePlan returned
+  bool anytime_planning_; ///<@brief parameter to flag whether makePlan returns on the first solution and the plan is improved in the background
+  double anytime_first_solution_time_; ///<@brief parameter to set time the planner gets to find a first solution before it falls back to the rest of solver_maxtime
+  double anytime_improvement_time_; ///<@brief parameter to set maximum time the plan is improved in the background
+  boost::shared_ptr<boost::thread> anytime_thread_; ///<@brief worker improving the last plan, writes last_path_ while running
 
   // Topics & Services
   ros::Publisher plan_pub_; ///<@brief topic used to publish resulting plan for visualization
   ros::Publisher diagnostic_ompl_pub_; ///<@brief topic used to publish some diagnostic data about the results of the ompl
   ros::Publisher stats_ompl_pub_; ///<@brief topic used to publish some statistics about the planner plugin
+  ompl_planner_base::OMPLPlannerDiagnostics::ConstPtr last_diagnostics_; ///<@brief diagnostics published for the last query
+  ompl_planner_base::OMPLPlannerBaseStats::ConstPtr last_statistics_; ///<@brief statistics published for the last query
+  ros::ServiceServer save_roadmap_srv_; ///<@brief service to store the roadmap of the cached PRM
+  ros::ServiceServer dump_trace_srv_; ///<@brief service to write the trace buffer as Chrome trace
+  ros::ServiceServer make_plans_srv_; ///<@brief service to plan a batch of queries
+  ros::ServiceServer make_plan_to_any_goal_srv_; ///<@brief service to plan to the first reached of several goals
+
+  // batch planning
+  int batch_threads_; ///<@brief parameter to set number of threads the queries of a batch are distributed over
 
   /**
-     * @brief  Checks the legality of the robot footprint at a position and orientation using the world model
+     * @brief Queries of a batch, handed out to the worker threads one by one
      */
-  double footprintCost(const geometry_msgs::Pose2D &pose);
+  struct BatchRun
+  {
+    boost::mutex mutex;
+    unsigned int next_query;
+    std::vector<geometry_msgs::Pose2D> starts, goals;
+    std::vector<unsigned char> feasible; ///< @brief queries which failed the checks are not planned
+    std::vector<BatchPlanResult>* results;
+    bool lengths_only;
+  };
+
+  // parameters are received by dynamic reconfigure and applied at the start of the next query
+  boost::shared_ptr<dynamic_reconfigure::Server<OMPLPlannerBaseConfig> > dsrv_;
+  boost::mutex config_mutex_; ///<@brief protects the configuration received by the dynamic reconfigure server
+  OMPLPlannerBaseConfig config_; ///<@brief configuration received last
+  bool config_changed_; ///<@brief flag whether config_ has been received since it has been applied last
+
+  /**
+     * @brief  Checks the legality of the robot footprint at a position and orientation on the costmap view (same semantics as base_local_planner::CostmapModel)
+     *         Reentrant -> may be called from several planner threads at once
+     */
+  double footprintCost(const geometry_msgs::Pose2D &pose) const;
 
   /**
      * @brief Interface class to footprint check for ompl planning library
      * @param state_SE2 The pose of the robot in the plaine as provided by ompl SE2 manifold (x, y, yaw)
      * @return true if pose valid, false otherwise
      */
-  bool isStateValid2DGrid(const ompl::base::State *state);
+  bool isStateValid2DGrid(const ompl::base::State *state) const;
+
+  /**
+     * @brief Checks a state (tiered check, validity cache and footprint check), called by isStateValid2DGrid which counts the checks
+     */
+  bool checkStateValidity(const ompl::base::State *state) const;
+
+  /**
+     * @brief Copies the counters of the validity and motion checks and the state memory of the current query into the diagnostics
+     */
+  void fillCheckCounters(ompl_planner_base::OMPLPlannerDiagnostics& msg) const;
+
+  /**
+     * @brief (Re-)builds the footprint lookup table if footprint, costmap resolution or number of yaw bins changed
+     */
+  void updateFootprintLookupTable();
+
+  /**
+     * @brief Reads the inflation cost at the fast accept distance from the inflation layer of the costmap
+     *        (fast accept is disabled if the inflation radius does not reach that far), recomputed only on changes
+     */
+  void updateCircumscribedCost();
+
+  /**
+     * @brief Returns the distance in cells from the center cell up to which the footprint check may look at cells
+     */
+  static unsigned int getFastAcceptDistance(double circumscribed_radius, double resolution);
+
+  /**
+     * @brief Marks the blocks of the costmap view containing unknown cells
+     * @param map_comparable True if the change tracker compared against the view of the last query,
+     *        only the blocks overlapping its changes are scanned then
+     */
+  void updateUnknownBlocks(bool map_comparable);
 
   /**
-     * @brief Interpolates path returned from ompl to fit density-requirements of local planner
-     * @param Path to be interpolated as vector of Pose2D
-     * @return true if interpolation succesful
+     * @brief Checks whether all cells within the fast accept distance of a cell are on the map and known
      */
-  bool interpolatePathPose2D(std::vector<geometry_msgs::Pose2D>& path);
+  bool isKnownAround(unsigned int cell_x, unsigned int cell_y) const;
+
+  /**
+     * @brief Number of frames to insert between two frames of the path to fit density-requirements of local planner
+     */
+  unsigned int getNumInsertions(const geometry_msgs::Pose2D& last_frame, const geometry_msgs::Pose2D& curr_frame) const;
+
+  /**
+     * @brief Re-validates the rest of the last plan if the goal did not change
+     *        The start is connected to the vertex following its projection onto the last plan, and the last vertex is replaced by the goal
+     * @param path Set to the remaining plan from start to goal if it is still collision free
+     * @return true if the last plan can be reused
+     */
+  bool reuseLastPlan(const geometry_msgs::Pose2D& start, const geometry_msgs::Pose2D& goal,
+                     const ompl::base::SpaceInformationPtr& si, ompl::geometric::PathGeometric& path);
 
   // Visualization
 
@@ -225,16 +520,211 @@ private:
      */
   void publishPlan(const std::vector<geometry_msgs::PoseStamped> &path);
 
+  /**
+     * @brief Simplifies the solution within simplify_maxtime, either by ompl's path simplifier or by shortcuts checked on the grid
+     * @return number of removed vertices
+     */
+  unsigned int simplifyPath(ompl::geometric::PathSimplifier& simplifier, ompl::geometric::PathGeometric& path);
+
+  /**
+     * @brief Greedily connects each vertex of the path to the furthest later vertex whose straight connection is free
+     *        Connections are checked by sweeping the footprint over the costmap, ignoring the motion validator of the space information
+     * @return number of removed vertices
+     */
+  unsigned int shortcutPathOnGrid(ompl::geometric::PathGeometric& path, const ompl::base::PlannerTerminationCondition& ptc);
+
+  /**
+     * @brief Converts a path of ompl into a plan (interpolated if interpolate_path is set)
+     *        The plan is sized once and written in place, all frames share one time stamp
+     * @param frame_id Frame of the plan, the global frame of the costmap
+     * @return false if the interpolation failed (path with less than 2 states)
+     */
+  bool convertPath(const ompl::geometric::PathGeometric& path, const std::string& frame_id,
+                   std::vector<geometry_msgs::PoseStamped>& plan);
+
+  /**
+     * @brief Starts the worker improving a copy of the path in the background
+     */
+  void startAnytimeImprovement(const ompl::geometric::PathGeometric& path);
+
+  /**
+     * @brief Interrupts and joins the worker improving the last plan (does nothing if none is running)
+     */
+  void stopAnytimeImprovement();
+
+  /**
+     * @brief Stops the anytime worker and forgets the last plan -> a failed query is never continued by reuse or the worker
+     */
+  void discardLastPlan();
+
+  /**
+     * @brief Thread function shortcutting the path until no more improvement is found, the time is up or the thread is interrupted
+     *        Each improvement is stored as last plan and published for visualization
+     */
+  void runAnytimeImprovement(ompl::geometric::PathGeometricPtr path);
+
   // Configuration
 
   /**
-     * @brief Read desired planner type from parameter server and set according ompl planner to simple setup
+     * @brief Creates state space, simple setup and planner for the given bounds, or reuses the ones of the last query
+     *        if persistent_setup is set and neither bounds, validity checking resolution, motion validation nor footprint changed
+     *        (if only planner type, roadmap caching or number of planner threads changed, only the planner is replaced)
+     * @param bounds Bounds of the (x, y) part of the SE2 state space
+     */
+  void updateSimpleSetup(const ompl::base::RealVectorBounds& bounds);
+
+  /**
+     * @brief Hands the costmap of the current query to the motion validator (if motions are not checked by the ompl default)
+     */
+  void updateMotionValidator();
+
+  /**
+     * @brief Allocates or frees the validity cache according to the parameters and drops entries covering changed costmap cells
+     * @param map_comparable false if the costmap change tracker had no comparable copy of the map (all entries are dropped)
+     */
+  void updateValidityCache(bool map_comparable);
+
+  /**
+     * @brief Builds, updates or drops the connectivity index according to the parameters
+     * @param map_comparable false if the costmap change tracker had no comparable copy of the map (index is rebuilt)
+     */
+  void updateConnectivityIndex(bool map_comparable);
+
+  /**
+     * @brief Plans on the downsampled costmap and sets the corridor around the path found the planner samples in
+     * @return false if there is no path on the coarse grid (corridor stays empty)
+     */
+  bool updateCorridor(const geometry_msgs::Pose2D& start, const geometry_msgs::Pose2D& goal);
+
+  /**
+     * @brief Re-validates the cached roadmap in the region of the costmap that changed since the last query
+     * @param map_comparable false if the changed region is unknown (whole roadmap is re-validated)
+     */
+  void updateRoadmap(bool map_comparable);
+
+  /**
+     * @brief Gets the bounds of the (x, y) part of the state space from the costmap
+     */
+  void getMapBounds(ompl::base::RealVectorBounds& bounds);
+
+  /**
+     * @brief Gets the bounds of the region of interest around start and goal (clipped to the bounds of the map)
+     * @param scale Factor the inflation of the box spanned by start and goal is scaled with
+     * @return true if the region covers the whole map (growing it further makes no difference)
+     */
+  bool getRegionBounds(const geometry_msgs::Pose2D& start, const geometry_msgs::Pose2D& goal, double scale,
+                       const ompl::base::RealVectorBounds& map_bounds, ompl::base::RealVectorBounds& bounds);
+
+  /**
+     * @brief Sets new bounds on the state space of the simple setup, keeping the setup and its planner
+     */
+  void updateStateSpaceBounds(const ompl::base::RealVectorBounds& bounds);
+
+  /**
+     * @brief Name of the roadmap file in roadmap_directory for the current map geometry, footprint and planner
+     */
+  std::string getRoadmapFileName();
+
+  /**
+     * @brief Loads the roadmap for the current map and footprint from roadmap_directory into the cached PRM
+     * @return true if a roadmap has been loaded
+     */
+  bool loadRoadmap();
+
+  /**
+     * @brief Service callback to store the roadmap of the cached PRM to disk
+     */
+  bool saveRoadmapService(ompl_planner_base::SaveRoadmap::Request& req, ompl_planner_base::SaveRoadmap::Response& res);
+
+  /**
+     * @brief Service callback to write the events of the trace buffer to a Chrome trace file
+     */
+  bool dumpTraceService(ompl_planner_base::DumpTrace::Request& req, ompl_planner_base::DumpTrace::Response& res);
+
+  /**
+     * @brief Service callback to plan a batch of queries (see makePlans)
+     */
+  bool makePlansService(ompl_planner_base::MakePlans::Request& req, ompl_planner_base::MakePlans::Response& res);
+
+  /**
+     * @brief Service callback to plan to the first reached of several goals (see makePlanToAnyGoal)
+     */
+  bool makePlanToAnyGoalService(ompl_planner_base::MakePlanToAnyGoal::Request& req, ompl_planner_base::MakePlanToAnyGoal::Response& res);
+
+  /**
+     * @brief Gets an up to date copy (or view) of the costmap and the footprint and updates everything derived from them
+     * @param use_snapshot True to plan on a copy of the costmap, false to plan on the costmap itself
+     */
+  void updateCostmap(bool use_snapshot);
+
+  /**
+     * @brief Checks start and goal of a query against the footprint costs, the free space components and the bounds
+     * @return false if no planner can find a path for the query
+     */
+  bool isQueryFeasible(const geometry_msgs::Pose2D& start, const geometry_msgs::Pose2D& goal);
+
+  /**
+     * @brief Thread function solving queries of a batch with its own planner on the space information of the simple setup
+     */
+  void runBatchWorker(BatchRun* run);
+
+  /**
+     * @brief Set ompl planner according to the planner type read from parameter server to simple setup
+     *        (or allocate the planners of the portfolio if a comma separated list of planners is given)
      * @param Reference to SimpleSetup
      */
   void setPlannerType(ompl::geometric::SimpleSetup& simple_setup);
 
+  /**
+     * @brief Allocates the ompl planner of the given type
+     * @return Pointer to the planner, empty pointer if the planner type is not supported
+     */
+  ompl::base::PlannerPtr createPlanner(const std::string& planner_type, const ompl::base::SpaceInformationPtr& si_ptr);
+
+  /**
+     * @brief Runs all planners of the portfolio concurrently on the start and goal of the simple setup and stops at the first exact solution
+     * @param simple_setup SimpleSetup with start and goal set, receives the solution path
+     * @param max_time Time the planners may take [s]
+     * @param winning_planner Type of the planner which found the solution
+     * @return true if a solution has been found
+     */
+  bool solvePortfolio(ompl::geometric::SimpleSetup& simple_setup, double max_time, std::string& winning_planner);
+
+  /**
+     * @brief Solves the query of the simple setup with the configured planner, portfolio or anytime mode
+     * @param max_time Time the planners may take [s]
+     * @param winning_planner Type of the planner which found the solution
+     * @param planning_time Time spent solving
+     * @return true if a solution has been found
+     */
+  bool solve(ompl::geometric::SimpleSetup& simple_setup, double max_time, std::string& winning_planner, double& planning_time);
+
+  /**
+     * @brief Thread function running one planner of the portfolio
+     */
+  void runPortfolioPlanner(unsigned int index, const ompl::base::PlannerTerminationCondition& ptc, PortfolioRace* race);
+
+  /**
+     * @brief Callback of the dynamic reconfigure server, stores the configuration to be applied by the next query
+     */
+  void reconfigureCB(OMPLPlannerBaseConfig& config, uint32_t level);
+
+  /**
+     * @brief Applies the configuration received last by the dynamic reconfigure server (does nothing if it did not change)
+     */
   void readParameters();
 
+  /**
+     * @brief Formats the configuration as one "type name value" line per parameter
+     */
+  static void formatParameters(const OMPLPlannerBaseConfig& config, std::string& parameters);
+
+  /**
+     * @brief Hands start, goal, parameters, footprint and the costmap view of the query to the recorder
+     *        (opens the record files on the first call)
+     */
+  void recordRequest(const geometry_msgs::Pose2D& start, const geometry_msgs::Pose2D& goal);
+
 };
 }
 
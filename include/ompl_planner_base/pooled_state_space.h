@@ -0,0 +1,139 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#ifndef OMPL_PLANNER_BASE_POOLED_STATE_SPACE_H
+#define OMPL_PLANNER_BASE_POOLED_STATE_SPACE_H
+
+// ompl planner specific classes
+#include <ompl/base/State.h>
+#include <ompl/base/spaces/SE2StateSpace.h>
+
+// boost classes
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/tss.hpp>
+
+// std c++ classes
+#include <stddef.h>
+
+
+namespace ompl_planner_base{
+
+/**
+ * @class StatePool
+ * @brief Pool of SE2 states which is kept across queries, states are returned to a free list instead of the heap
+ *
+ * Every state (compound state, its component array and both components) lives in one block, blocks are allocated
+ * in chunks. Each thread allocates from and frees into its own cache of blocks, the caches exchange batches of
+ * blocks with the central free list of the pool, so the lock of the pool is only taken once per batch (planner
+ * threads, portfolio threads and batch workers allocate concurrently). At the start of a query the peak number of
+ * blocks handed out during the finished query is remembered and chunks without handed out blocks are released as
+ * long as the remaining chunks hold the largest peak of the recent queries.
+ */
+class StatePool : private boost::noncopyable {
+
+public:
+  /**
+     * @param history_length Number of recent queries whose peak the retained chunks are sized from
+     */
+  StatePool(unsigned int history_length = 16);
+
+  /**
+     * @brief  Destructor, returns the cache of the calling thread (chunks are freed once the caches of all
+     *         other threads are returned as well, states still allocated from the pool become invalid)
+     */
+  ~StatePool();
+
+  ompl::base::SE2StateSpace::StateType* allocate();
+
+  /**
+     * @param state Has to be allocated from this pool (by any thread)
+     */
+  void release(ompl::base::State* state);
+
+  /**
+     * @brief Ends the previous query: remembers its peak, releases the free chunks beyond the recent peaks
+     *        and restarts the peak at the blocks handed out
+     */
+  void beginQuery();
+
+  /**
+     * @brief Returns the largest memory handed out to states and thread caches since the start of the query in bytes
+     */
+  size_t getPeakBytes() const;
+
+  /**
+     * @brief Returns the memory held by the pool (all chunks) in bytes
+     */
+  size_t getRetainedBytes() const;
+
+private:
+  struct Block;
+  struct Chunk;
+  class Central;
+  struct ThreadCache;
+
+  ThreadCache& getThreadCache();
+
+  boost::shared_ptr<Central> central_; ///< @brief chunks and central free list, shared with the caches of the threads
+  boost::thread_specific_ptr<ThreadCache> thread_cache_;
+};
+
+typedef boost::shared_ptr<StatePool> StatePoolPtr;
+
+
+/**
+ * @class PooledSE2StateSpace
+ * @brief SE2 state space allocating its states from a StatePool
+ *
+ * The space keeps the pool alive, states are only used through the space (paths, planner data and the planner hold it).
+ */
+class PooledSE2StateSpace : public ompl::base::SE2StateSpace {
+
+public:
+  PooledSE2StateSpace(const StatePoolPtr& pool);
+
+  virtual ompl::base::State* allocState() const;
+
+  virtual void freeState(ompl::base::State* state) const;
+
+private:
+  StatePoolPtr pool_;
+};
+}
+
+#endif
@@ -0,0 +1,93 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#ifndef OMPL_PLANNER_BASE_PROFILING_MOTION_VALIDATOR_H
+#define OMPL_PLANNER_BASE_PROFILING_MOTION_VALIDATOR_H
+
+#include <ompl_planner_base/validity_statistics.h>
+#include <ompl_planner_base/trace_buffer.h>
+
+// ompl planner specific classes
+#include <ompl/base/MotionValidator.h>
+#include <ompl/base/SpaceInformation.h>
+
+// std c++ classes
+#include <utility>
+
+
+namespace ompl_planner_base{
+
+/**
+ * @class ProfilingMotionValidator
+ * @brief Motion validator forwarding all checks to another motion validator while counting (and optionally timing or tracing) them
+ */
+class ProfilingMotionValidator : public ompl::base::MotionValidator {
+
+public:
+  /**
+     * @brief  Constructor for the motion validator
+     * @param  si The space information the motions are checked in
+     * @param  validator The motion validator doing the checks
+     * @param  statistics Counters the checks are added to (have to outlive the motion validator)
+     */
+  ProfilingMotionValidator(ompl::base::SpaceInformation* si, const ompl::base::MotionValidatorPtr& validator,
+                           ValidityStatistics* statistics);
+
+  /**
+     * @brief Sets whether the time spent in the checks is measured (must not be called while planning)
+     */
+  void setTiming(bool timing) { timing_ = timing; }
+
+  /**
+     * @brief Sets the trace every check is recorded to as complete event (NULL -> no tracing, must not be called while planning)
+     */
+  void setTrace(TraceBuffer* trace) { trace_ = trace; }
+
+  virtual bool checkMotion(const ompl::base::State* s1, const ompl::base::State* s2) const;
+
+  virtual bool checkMotion(const ompl::base::State* s1, const ompl::base::State* s2,
+                           std::pair<ompl::base::State*, double>& last_valid) const;
+
+private:
+  ompl::base::MotionValidatorPtr validator_;
+  ValidityStatistics* statistics_;
+  bool timing_;
+  TraceBuffer* trace_;
+};
+}
+
+#endif
@@ -0,0 +1,225 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#ifndef OMPL_PLANNER_BASE_REQUEST_RECORDER_H
+#define OMPL_PLANNER_BASE_REQUEST_RECORDER_H
+
+#include <ompl_planner_base/costmap_view.h>
+#include <geometry_msgs/Point.h>
+#include <geometry_msgs/Pose2D.h>
+#include <nav_msgs/OccupancyGrid.h>
+
+// boost classes
+#include <boost/cstdint.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+// std c++ classes
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+
+namespace ompl_planner_base{
+
+/**
+ * @brief One planning request as stored in a record file
+ */
+struct RecordedRequest
+{
+  boost::uint64_t sequence; ///< @brief number of the request, counted over all files of a recorder
+  double stamp; ///< @brief ros time of the request [s]
+  geometry_msgs::Pose2D start, goal;
+  std::vector<geometry_msgs::Point> footprint;
+  std::string parameters; ///< @brief parameters in effect, one "type name value" line per parameter
+  unsigned int size_x, size_y;
+  double resolution, origin_x, origin_y;
+  std::vector<unsigned char> costs; ///< @brief cells of the costmap (only filled by the reader)
+
+  RecordedRequest() : sequence(0), stamp(0.0), size_x(0), size_y(0), resolution(0.0), origin_x(0.0), origin_y(0.0){}
+
+  /**
+     * @brief Returns a view onto the recorded cells (valid until the costs are changed)
+     */
+  CostmapView getView() const
+  {
+    if(costs.empty())
+      return CostmapView();
+    return CostmapView(&costs[0], size_x, size_y, resolution, origin_x, origin_y);
+  }
+};
+
+
+/**
+ * @class RequestRecorder
+ * @brief Appends planning requests to a ring of memory-mapped files of fixed size
+ *
+ * record() only copies the request and the cells of the costmap into a pending slot, a background thread encodes
+ * the slot into the mapped file. The costmap is run-length encoded, as difference to the costmap of the previous
+ * record if the geometry did not change (the first record of every file is encoded completely, so each file can be
+ * read on its own). Requests arriving while the slot is still being written are dropped and counted.
+ * Once a file is full, recording continues in the next one, overwriting the oldest.
+ */
+class RequestRecorder : private boost::noncopyable {
+
+public:
+  RequestRecorder();
+
+  /**
+     * @brief  Destructor, writes the pending request and closes the file
+     */
+  ~RequestRecorder();
+
+  /**
+     * @brief Opens the ring of files <directory>/requests_<i>.rec, continuing after the newest record of files
+     *        written earlier, and starts the writer thread
+     * @param file_size Size of each file in bytes
+     * @return false if the first file could not be created
+     */
+  bool open(const std::string& directory, size_t file_size, unsigned int num_files);
+
+  /**
+     * @brief Writes the pending request, stops the writer thread and unmaps the file
+     */
+  void close();
+
+  bool isOpen() const { return writer_thread_ != NULL; }
+
+  /**
+     * @brief Queues a request for writing, the sequence number and the costs of the request are filled in by the recorder
+     * @param costmap Cells are copied before returning
+     * @return false if the request was dropped since the previous one is still being written
+     */
+  bool record(const RecordedRequest& request, const CostmapView& costmap);
+
+  unsigned long getNumRecorded() const;
+  unsigned long getNumDropped() const;
+
+private:
+  /**
+     * @brief Thread function, writes the pending request until the recorder is closed
+     */
+  void runWriter();
+
+  /**
+     * @brief Encodes the request into the current file, starting the next file if it does not fit
+     *        (takes over the costs of the request as base of the next delta)
+     * @return false if the request could not be written
+     */
+  bool write(RecordedRequest& request);
+
+  /**
+     * @brief Creates (or truncates) file index of the ring and maps it
+     */
+  bool startFile(unsigned int index, boost::uint64_t first_sequence);
+
+  std::string directory_;
+  size_t file_size_;
+  unsigned int num_files_, file_index_;
+  boost::scoped_ptr<boost::interprocess::mapped_region> region_;
+
+  // costmap of the last record in the current file -> base of the next delta (only used by the writer thread)
+  std::vector<unsigned char> previous_costs_, delta_, encoded_;
+  unsigned int previous_size_x_, previous_size_y_;
+  double previous_resolution_, previous_origin_x_, previous_origin_y_;
+  bool has_previous_;
+
+  // pending request, guarded by mutex_ (owned by the writer thread while pending_ is set)
+  mutable boost::mutex mutex_;
+  boost::condition_variable pending_cond_;
+  RecordedRequest pending_request_;
+  bool pending_, shutdown_;
+  boost::uint64_t next_sequence_;
+  unsigned long num_recorded_, num_dropped_;
+  boost::thread* writer_thread_;
+};
+
+
+/**
+ * @class RequestReader
+ * @brief Reads the requests of record files written by a RequestRecorder, in the order they were recorded
+ */
+class RequestReader : private boost::noncopyable {
+
+public:
+  RequestReader();
+
+  /**
+     * @brief Opens the record files, they are read in the order of their first record
+     * @return false if one of the files is no record file
+     */
+  bool open(const std::vector<std::string>& files);
+
+  /**
+     * @brief Reads the next request (costs are decoded completely)
+     * @return false if all records have been read
+     */
+  bool next(RecordedRequest& request);
+
+private:
+  bool openFile(unsigned int index);
+
+  std::vector<std::string> files_;
+  unsigned int file_index_;
+  boost::scoped_ptr<boost::interprocess::file_mapping> mapping_;
+  boost::scoped_ptr<boost::interprocess::mapped_region> region_;
+  size_t offset_, end_;
+
+  // cells of the previous record of the current file -> base of deltas
+  std::vector<unsigned char> previous_costs_;
+};
+
+
+/**
+ * @brief Converts the costs of a recorded request into an occupancy grid with the same geometry
+ *        (unknown -> -1, inscribed or lethal -> 100, everything else -> 0), e.g. for the static layer of a replaying costmap
+ */
+void recordToMap(const RecordedRequest& request, const std::string& frame_id, nav_msgs::OccupancyGrid& map);
+
+/**
+ * @brief Formats a footprint as footprint parameter of a costmap ("[[x, y], ...]")
+ */
+std::string formatFootprint(const std::vector<geometry_msgs::Point>& footprint);
+
+}
+
+#endif
@@ -0,0 +1,127 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#ifndef OMPL_PLANNER_BASE_STREAMING_STATISTICS_H
+#define OMPL_PLANNER_BASE_STREAMING_STATISTICS_H
+
+// std c++ classes
+#include <vector>
+
+
+namespace ompl_planner_base{
+
+/**
+ * @class RunningStatistics
+ * @brief Count, mean, variance, minimum and maximum of a stream of samples in constant memory
+ *
+ * Mean and variance are updated by Welford's method, which stays accurate for long streams
+ * and small variances (unlike the difference of the mean of the squares and the squared mean).
+ */
+class RunningStatistics {
+
+public:
+  RunningStatistics() { reset(); }
+
+  void reset();
+
+  void add(double value);
+
+  unsigned long getCount() const { return count_; }
+
+  double getMean() const { return mean_; }
+
+  /**
+     * @brief Returns the sample variance (0 for less than two samples)
+     */
+  double getVariance() const;
+
+  double getStdDev() const;
+
+  double getMin() const { return min_; }
+
+  double getMax() const { return max_; }
+
+private:
+  unsigned long count_;
+  double mean_;
+  double m2_; ///< @brief sum of squared differences from the current mean
+  double min_, max_;
+};
+
+
+/**
+ * @class QuantileHistogram
+ * @brief Histogram with logarithmically growing buckets to estimate quantiles of a stream of positive samples in constant memory
+ *
+ * Bucket i holds the samples in (min_value * gamma^(i-1), min_value * gamma^i] with gamma = (1 + relative_error) / (1 - relative_error),
+ * so every quantile inside [min_value, max_value] is estimated with at most relative_error. Samples below min_value
+ * are gathered in the first bucket and samples above max_value in the last one.
+ */
+class QuantileHistogram {
+
+public:
+  /**
+     * @brief  Constructor for an empty histogram
+     * @param  min_value Smallest sample resolved (has to be positive)
+     * @param  max_value Largest sample resolved
+     * @param  relative_error Relative error of the estimated quantiles (in (0, 1))
+     */
+  QuantileHistogram(double min_value = 1e-6, double max_value = 1e4, double relative_error = 0.01);
+
+  void reset();
+
+  void add(double value);
+
+  unsigned long getCount() const { return count_; }
+
+  /**
+     * @brief Estimates the q-quantile of the samples added so far (0 if there are none)
+     * @param q Quantile in [0, 1], e.g. 0.99 for the 99th percentile
+     */
+  double getQuantile(double q) const;
+
+private:
+  double min_value_;
+  double gamma_;
+  double inv_log_gamma_;
+  std::vector<unsigned long> buckets_;
+  unsigned long count_;
+  double min_, max_; ///< @brief extremes of the samples, bound the estimates of the outer buckets
+};
+}
+
+#endif
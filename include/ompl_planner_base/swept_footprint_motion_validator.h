@@ -0,0 +1,140 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#ifndef OMPL_PLANNER_BASE_SWEPT_FOOTPRINT_MOTION_VALIDATOR_H
+#define OMPL_PLANNER_BASE_SWEPT_FOOTPRINT_MOTION_VALIDATOR_H
+
+#include <ompl_planner_base/costmap_view.h>
+#include <geometry_msgs/Point.h>
+
+// ompl planner specific classes
+#include <ompl/base/MotionValidator.h>
+#include <ompl/base/SpaceInformation.h>
+
+// boost classes
+#include <boost/thread/tss.hpp>
+
+// std c++ classes
+#include <utility>
+#include <vector>
+
+
+namespace ompl_planner_base{
+
+/**
+ * @class SweptFootprintMotionValidator
+ * @brief Motion validator for SE2 which checks the area swept by the footprint along a motion
+ *
+ * The motion is split into sub-steps with the yaw interpolated through the state space like in the planners. The swept
+ * area of a sub-step is approximated by the convex hull of the footprint at both of its poses, with the rotation per sub-step
+ * bounded such that the hull deviates by less than half a cell from the arcs of the corners. All cells covered by the
+ * sub-steps are marked in a mask, so each cell is tested only once per motion. The filled area is checked, which equals
+ * the check of the outline for convex footprints as inflation costs decrease with the distance to an obstacle;
+ * non-convex footprints are treated conservatively like their convex hull.
+ */
+class SweptFootprintMotionValidator : public ompl::base::MotionValidator {
+
+public:
+  /**
+     * @brief  Constructor for the motion validator
+     * @param  si The space information (SE2) the motions are checked in
+     */
+  SweptFootprintMotionValidator(ompl::base::SpaceInformation* si);
+
+  /**
+     * @brief Sets the costmap and footprint to check against (must not be called while planning)
+     * @param costmap View onto the costmap of the current query
+     * @param footprint The footprint specification of the robot (in the robot frame)
+     * @param max_cost Cost from which on a cell is treated as collision (lethal and unknown cells always are)
+     */
+  void setCostmap(const CostmapView& costmap, const std::vector<geometry_msgs::Point>& footprint, int max_cost);
+
+  /**
+     * @brief Checks whether the motion from s1 to s2 is valid (s1 is assumed to be valid)
+     */
+  virtual bool checkMotion(const ompl::base::State* s1, const ompl::base::State* s2) const;
+
+  /**
+     * @brief Checks whether the motion from s1 to s2 is valid and reports the last valid state of the motion otherwise
+     */
+  virtual bool checkMotion(const ompl::base::State* s1, const ompl::base::State* s2,
+                           std::pair<ompl::base::State*, double>& last_valid) const;
+
+private:
+  // buffers used while checking a motion, one per planner thread
+  struct Scratch
+  {
+    std::vector<unsigned char> mask; ///< @brief cells of the bounding box of the motion already tested
+    std::vector<std::pair<double, double> > corners; ///< @brief corners of the footprint at both poses of a sub-step (in cells)
+    std::vector<std::pair<double, double> > points; ///< @brief corners sorted for the hull computation
+    std::vector<std::pair<double, double> > hull; ///< @brief convex hull of the corners (counter-clockwise)
+  };
+
+  /**
+     * @brief Checks the swept area of the motion from s1 to s2
+     * @return the fraction of the motion known to be valid, 1.0 if the whole motion is valid
+     */
+  double checkSweptArea(const ompl::base::State* s1, const ompl::base::State* s2) const;
+
+  /**
+     * @brief Adds the corners of the footprint at a state (in cell coordinates of the costmap) to the corners of the scratch
+     */
+  void addFootprintCorners(const ompl::base::State* state, Scratch& scratch) const;
+
+  /**
+     * @brief Computes the convex hull of the corners of the scratch
+     */
+  void computeConvexHull(Scratch& scratch) const;
+
+  /**
+     * @brief Tests all cells covered by the hull of the scratch which have not been tested for this motion yet
+     * @return false if the hull leaves the map or covers a cell in collision
+     */
+  bool checkHullCells(Scratch& scratch, int mask_min_x, int mask_min_y, int mask_size_x) const;
+
+  Scratch& getScratch() const;
+
+  CostmapView costmap_;
+  std::vector<geometry_msgs::Point> footprint_;
+  double circumscribed_radius_; ///< @brief distance of the corner of the footprint furthest away from its origin
+  int max_cost_;
+
+  mutable boost::thread_specific_ptr<Scratch> scratch_;
+};
+}
+
+#endif
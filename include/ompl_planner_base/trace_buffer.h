@@ -0,0 +1,217 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#ifndef OMPL_PLANNER_BASE_TRACE_BUFFER_H
+#define OMPL_PLANNER_BASE_TRACE_BUFFER_H
+
+// boost classes
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+
+// std c++ classes
+#include <ostream>
+#include <string>
+#include <vector>
+#include <time.h>
+
+
+namespace ompl_planner_base{
+
+/**
+ * @class TraceBuffer
+ * @brief Records timestamped events into one fixed-size ring buffer per thread and exports them as Chrome trace
+ *
+ * Every thread writes only into its own ring buffer, so recording needs neither locks nor atomic
+ * read-modify-write operations. The mutex is only taken when a thread records its first event and
+ * when the buffers are exported. Old events are overwritten once a ring buffer is full.
+ * Buffers of finished threads are handed to threads started later (e.g. the planner threads of each query),
+ * so the memory is bounded by the number of threads running at once.
+ * Names of events and threads are stored as pointers and have to be string literals.
+ */
+class TraceBuffer {
+
+public:
+  enum Phase
+  {
+    BEGIN = 'B',
+    END = 'E',
+    COMPLETE = 'X', ///< @brief event with duration (value in nanoseconds)
+    INSTANT = 'i',
+    COUNTER = 'C'
+  };
+
+  /**
+     * @brief  Constructor for a disabled trace buffer
+     * @param  capacity Number of events per thread (rounded up to a power of two)
+     */
+  explicit TraceBuffer(unsigned int capacity = 16384);
+
+  /**
+     * @brief Sets the number of events per thread, only possible before the first event has been recorded
+     * @return false if events have been recorded already
+     */
+  bool setCapacity(unsigned int capacity);
+
+  void setEnabled(bool enabled) { enabled_.store(enabled, boost::memory_order_relaxed); }
+
+  inline bool isEnabled() const { return enabled_.load(boost::memory_order_relaxed); }
+
+  /**
+     * @brief Records an event of the calling thread (does nothing if tracing is disabled)
+     * @param name Name of the event (string literal)
+     * @param phase Type of the event
+     * @param value Value of a counter or duration of a complete event
+     */
+  inline void record(const char* name, Phase phase, boost::int64_t value = 0)
+  {
+    if(isEnabled())
+      recordEvent(name, phase, now(), value);
+  }
+
+  /**
+     * @brief Records an event which started at start_time and ended now (does nothing if tracing is disabled)
+     */
+  inline void recordComplete(const char* name, boost::uint64_t start_time)
+  {
+    if(isEnabled())
+      recordEvent(name, COMPLETE, start_time, now() - start_time);
+  }
+
+  /**
+     * @brief Names the track of the calling thread in the trace (string literal)
+     */
+  void setThreadName(const char* name);
+
+  /**
+     * @brief Writes the events of all threads as Chrome trace (JSON object format, readable by chrome://tracing and Perfetto)
+     *        May be called while other threads are recording, events overwritten during the export are left out
+     */
+  void writeChromeTrace(std::ostream& stream) const;
+
+  /**
+     * @brief Writes the Chrome trace to a file
+     * @return false if the file could not be written
+     */
+  bool dump(const std::string& file_name) const;
+
+  /**
+     * @brief Monotonic time in nanoseconds, used for the timestamps of the events
+     */
+  static inline boost::uint64_t now()
+  {
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (boost::uint64_t) time.tv_sec * 1000000000ull + time.tv_nsec;
+  }
+
+private:
+  struct Event
+  {
+    boost::uint64_t timestamp;
+    boost::int64_t value;
+    const char* name;
+    char phase;
+  };
+
+  /**
+     * @brief Ring buffer written by a single thread
+     */
+  struct ThreadBuffer
+  {
+    std::vector<Event> events;
+    boost::atomic<boost::uint64_t> head; ///< @brief number of events written so far, published after the event is written
+    boost::atomic<const char*> thread_name;
+    boost::atomic<bool> in_use; ///< @brief cleared when the thread owning the buffer finished
+    unsigned int track;
+  };
+
+  /**
+     * @brief Per-thread handle to the ring buffer of the thread, returns the buffer when the thread finishes
+     */
+  struct ThreadHandle
+  {
+    boost::shared_ptr<ThreadBuffer> buffer;
+    ~ThreadHandle() { buffer->in_use.store(false, boost::memory_order_release); }
+  };
+
+  void recordEvent(const char* name, Phase phase, boost::uint64_t timestamp, boost::int64_t value);
+
+  ThreadBuffer& getThreadBuffer();
+
+  boost::atomic<bool> enabled_;
+  unsigned int capacity_;
+  boost::thread_specific_ptr<ThreadHandle> thread_handle_;
+  mutable boost::mutex buffers_mutex_; ///< @brief protects the list of buffers (not their events)
+  std::vector<boost::shared_ptr<ThreadBuffer> > buffers_;
+};
+
+
+/**
+ * @class TraceScope
+ * @brief Records a begin event on construction and the according end event on destruction (or on end())
+ */
+class TraceScope {
+
+public:
+  TraceScope(TraceBuffer& trace, const char* name) : trace_(trace), name_(name)
+  {
+    trace_.record(name_, TraceBuffer::BEGIN);
+  }
+
+  ~TraceScope() { end(); }
+
+  /**
+     * @brief Records the end event before the scope is left (at most once)
+     */
+  void end()
+  {
+    if(!name_)
+      return;
+    trace_.record(name_, TraceBuffer::END);
+    name_ = NULL;
+  }
+
+private:
+  TraceBuffer& trace_;
+  const char* name_;
+};
+}
+
+#endif
@@ -0,0 +1,131 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#ifndef OMPL_PLANNER_BASE_VALIDITY_CACHE_H
+#define OMPL_PLANNER_BASE_VALIDITY_CACHE_H
+
+// boost classes
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_array.hpp>
+
+// std c++ classes
+#include <stddef.h>
+
+
+namespace ompl_planner_base{
+
+/**
+ * @class ValidityCache
+ * @brief Bounded memo of state validity results keyed by the cell of the robot center and the yaw bin
+ *
+ * With the footprint lookup table, the result of a validity check only depends on the cell of the center and the yaw bin,
+ * so it can be shared by all states falling into the same cell and bin. Entries are single 64 bit words
+ * (cell index, yaw bin, generation, result) in an open-addressing table with bounded linear probing, which planner threads
+ * read and write without locks. Entries of older generations are treated as empty, so the whole cache is invalidated in constant time.
+ */
+class ValidityCache : private boost::noncopyable {
+
+public:
+  /**
+     * @brief  Constructor for an empty cache without table
+     */
+  ValidityCache();
+
+  /**
+     * @brief Allocates the table (if its size changes) and drops all entries
+     * @param max_bytes Memory the table may use, the number of entries is the largest power of two fitting in
+     * @return false if not even the table for a single probe sequence fits
+     */
+  bool allocate(size_t max_bytes);
+
+  /**
+     * @brief Frees the table
+     */
+  void release();
+
+  /**
+     * @brief Returns true if a table has been allocated
+     */
+  bool isAllocated() const { return capacity_ > 0; }
+
+  /**
+     * @brief Returns the memory used by the table in bytes
+     */
+  size_t getMemoryUsage() const { return capacity_ * sizeof(boost::uint64_t); }
+
+  /**
+     * @brief Looks up the result for a cell and yaw bin
+     * @param valid Set to the cached result if the entry is found
+     * @return true if the entry is found
+     */
+  bool lookup(unsigned int cell_index, unsigned int yaw_bin, bool& valid) const;
+
+  /**
+     * @brief Stores the result for a cell and yaw bin (may displace another entry)
+     */
+  void insert(unsigned int cell_index, unsigned int yaw_bin, bool valid);
+
+  /**
+     * @brief Drops all entries (must not be called while planner threads are running)
+     */
+  void invalidate();
+
+  /**
+     * @brief Drops the entries of the cells inside a region (must not be called while planner threads are running)
+     * @param size_x Width of the costmap in cells (to convert cell indices to cells)
+     * @return number of dropped entries
+     */
+  unsigned int invalidateRegion(unsigned int size_x, unsigned int min_x, unsigned int min_y, unsigned int max_x, unsigned int max_y);
+
+  /**
+     * @brief Maximum yaw bin which can be stored
+     */
+  static const unsigned int MAX_YAW_BIN = (1u << 14) - 1;
+
+private:
+  inline boost::uint64_t makeKey(unsigned int cell_index, unsigned int yaw_bin) const;
+  inline size_t homeSlot(unsigned int cell_index, unsigned int yaw_bin) const;
+
+  boost::scoped_array<boost::atomic<boost::uint64_t> > entries_;
+  size_t capacity_; ///< @brief number of entries, power of two
+  unsigned int generation_;
+};
+}
+
+#endif
@@ -0,0 +1,139 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#ifndef OMPL_PLANNER_BASE_VALIDITY_STATISTICS_H
+#define OMPL_PLANNER_BASE_VALIDITY_STATISTICS_H
+
+// boost classes
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/thread/thread.hpp>
+
+// std c++ classes
+#include <time.h>
+
+
+namespace ompl_planner_base{
+
+/**
+ * @class ValidityStatistics
+ * @brief Counters of the validity checker which can be incremented from several planner threads at once
+ *
+ * Every thread increments the counters of one of several slots (chosen by its thread id), each slot on its
+ * own cache line. This keeps parallel planners from contending on a single shared counter.
+ */
+class ValidityStatistics {
+
+public:
+  enum Counter
+  {
+    FAST_REJECT = 0,
+    FAST_ACCEPT,
+    FOOTPRINT_CHECK,
+    CACHE_HIT,
+    CACHE_MISS,
+    VALIDITY_CHECK,
+    VALIDITY_CHECK_TIME, ///< @brief nanoseconds
+    MOTION_CHECK,
+    MOTION_CHECK_TIME, ///< @brief nanoseconds
+    NUM_COUNTERS
+  };
+
+  /**
+     * @brief  Constructor, all counters are set to zero
+     */
+  ValidityStatistics() { reset(); }
+
+  /**
+     * @brief Increments a counter of the slot of the calling thread
+     */
+  inline void increment(Counter counter, boost::uint64_t value = 1)
+  {
+    slots_[slotIndex()].counters[counter].fetch_add(value, boost::memory_order_relaxed);
+  }
+
+  /**
+     * @brief Returns the sum of a counter over all slots
+     */
+  boost::uint64_t get(Counter counter) const
+  {
+    boost::uint64_t sum = 0;
+    for(unsigned int i = 0; i < NUM_SLOTS; i++)
+      sum += slots_[i].counters[counter].load(boost::memory_order_relaxed);
+    return sum;
+  }
+
+  /**
+     * @brief Monotonic time in nanoseconds, used for the time counters
+     */
+  static inline boost::uint64_t now()
+  {
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (boost::uint64_t) time.tv_sec * 1000000000ull + time.tv_nsec;
+  }
+
+  /**
+     * @brief Sets all counters to zero (must not be called while planner threads are running)
+     */
+  void reset()
+  {
+    for(unsigned int i = 0; i < NUM_SLOTS; i++)
+      for(unsigned int j = 0; j < NUM_COUNTERS; j++)
+        slots_[i].counters[j].store(0, boost::memory_order_relaxed);
+  }
+
+private:
+  static const unsigned int NUM_SLOTS = 16;
+
+  struct Slot
+  {
+    boost::atomic<boost::uint64_t> counters[NUM_COUNTERS];
+    char padding[64]; ///< @brief keeps counters of neighbouring slots on different cache lines
+  };
+
+  static inline unsigned int slotIndex()
+  {
+    return boost::hash<boost::thread::id>()(boost::this_thread::get_id()) % NUM_SLOTS;
+  }
+
+  Slot slots_[NUM_SLOTS];
+};
+}
+
+#endif
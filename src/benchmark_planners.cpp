@@ -0,0 +1,534 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#include <ros/ros.h>
+#include <tf/transform_listener.h>
+#include <tf/transform_datatypes.h>
+#include <costmap_2d/costmap_2d_ros.h>
+#include <nav_msgs/OccupancyGrid.h>
+
+// ros sandbox classes
+#include <ompl_planner_base/ompl_planner_base.h>
+#include <ompl_planner_base/costmap_snapshot.h>
+#include <ompl_planner_base/request_recorder.h>
+#include <ompl_planner_base/streaming_statistics.h>
+
+// ompl planner specific classes
+#include <ompl/util/RandomNumbers.h>
+
+// boost classes
+#include <boost/shared_ptr.hpp>
+
+// std c++ classes
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+/**
+ * @brief Start and goal of one benchmark query
+ */
+struct Query
+{
+  geometry_msgs::PoseStamped start, goal;
+  ompl_planner_base::CostmapSnapshotPtr snapshot; ///< @brief costmap of a recorded request (empty -> costmap of the map)
+};
+
+
+/**
+ * @brief Results of all runs of one planner
+ */
+struct PlannerSummary
+{
+  std::string planner;
+  unsigned int runs, successes;
+  ompl_planner_base::QuantileHistogram solve_time, simplification_time, total_time;
+  ompl_planner_base::RunningStatistics path_length, validity_checks;
+
+  PlannerSummary(const std::string& planner_type) : planner(planner_type), runs(0), successes(0){}
+};
+
+
+/**
+ * @brief Reads a PGM image (binary P5 or ascii P2, 8 bit), rows are stored from top to bottom
+ */
+bool loadPGM(const std::string& file_name, std::vector<unsigned char>& pixels, unsigned int& width, unsigned int& height)
+{
+  std::ifstream file(file_name.c_str(), std::ios::binary);
+  if(!file)
+    return false;
+
+  // header -> magic number, width, height and maximum value, separated by whitespaces and comments
+  std::string magic;
+  unsigned int header[3];
+  file >> magic;
+  for(unsigned int i = 0; (i < 3) && file; i++)
+  {
+    file >> std::ws;
+    while(file.peek() == '#')
+    {
+      file.ignore(4096, '\n');
+      file >> std::ws;
+    }
+    file >> header[i];
+  }
+  if( !file || ((magic != "P5") && (magic != "P2")) || (header[2] == 0) || (header[2] > 255) )
+    return false;
+
+  width = header[0];
+  height = header[1];
+  pixels.resize(width * height);
+  if(magic == "P5")
+  {
+    // exactly one whitespace between header and data
+    file.get();
+    file.read((char*) &pixels[0], pixels.size());
+  }
+  else
+  {
+    for(unsigned int i = 0; (i < pixels.size()) && file; i++)
+    {
+      unsigned int value;
+      file >> value;
+      pixels[i] = (unsigned char) value;
+    }
+  }
+  if(!file)
+    return false;
+
+  // scale to 8 bit
+  for(unsigned int i = 0; i < pixels.size(); i++)
+  {
+    pixels[i] = (unsigned char) (pixels[i] * 255 / header[2]);
+  }
+  return true;
+}
+
+
+/**
+ * @brief Reads a map stored by map_server (metadata in YAML next to a PGM image) into an occupancy grid (trinary mode of map_server)
+ */
+bool loadMap(const std::string& yaml_file, const std::string& frame_id, nav_msgs::OccupancyGrid& map)
+{
+  std::ifstream file(yaml_file.c_str());
+  if(!file)
+  {
+    ROS_ERROR("Could not open map file %s", yaml_file.c_str());
+    return false;
+  }
+
+  // flat "key: value" lines are all map_server writes
+  std::string image, line;
+  double resolution = 0.0, origin[3] = {0.0, 0.0, 0.0}, occupied_thresh = 0.65, free_thresh = 0.196;
+  int negate = 0;
+  while(std::getline(file, line))
+  {
+    const std::string::size_type colon = line.find(':');
+    if( (colon == std::string::npos) || (line[0] == '#') )
+      continue;
+    const std::string key = line.substr(0, line.find_last_not_of(" \t", colon - 1) + 1);
+    std::string value = line.substr(colon + 1);
+    std::replace(value.begin(), value.end(), '[', ' ');
+    std::replace(value.begin(), value.end(), ']', ' ');
+    std::replace(value.begin(), value.end(), ',', ' ');
+    std::istringstream value_stream(value);
+
+    if(key == "image")
+      value_stream >> image;
+    else if(key == "resolution")
+      value_stream >> resolution;
+    else if(key == "origin")
+      value_stream >> origin[0] >> origin[1] >> origin[2];
+    else if(key == "negate")
+      value_stream >> negate;
+    else if(key == "occupied_thresh")
+      value_stream >> occupied_thresh;
+    else if(key == "free_thresh")
+      value_stream >> free_thresh;
+  }
+
+  if(image.empty() || (resolution <= 0.0))
+  {
+    ROS_ERROR("Map file %s needs an image and a resolution", yaml_file.c_str());
+    return false;
+  }
+
+  // image path is relative to the map file
+  if( (image[0] != '/') && (yaml_file.find('/') != std::string::npos) )
+    image = yaml_file.substr(0, yaml_file.rfind('/') + 1) + image;
+
+  std::vector<unsigned char> pixels;
+  unsigned int width, height;
+  if(!loadPGM(image, pixels, width, height))
+  {
+    ROS_ERROR("Could not read map image %s (only 8 bit PGM images are supported)", image.c_str());
+    return false;
+  }
+
+  map.header.frame_id = frame_id;
+  map.header.stamp = ros::Time::now();
+  map.info.map_load_time = map.header.stamp;
+  map.info.resolution = resolution;
+  map.info.width = width;
+  map.info.height = height;
+  map.info.origin.position.x = origin[0];
+  map.info.origin.position.y = origin[1];
+  map.info.origin.orientation = tf::createQuaternionMsgFromYaw(origin[2]);
+
+  // image rows run from top to bottom -> flip to the cells of the grid
+  map.data.resize(width * height);
+  for(unsigned int y = 0; y < height; y++)
+  {
+    for(unsigned int x = 0; x < width; x++)
+    {
+      const unsigned char pixel = pixels[(height - y - 1) * width + x];
+      const double occupancy = negate ? pixel / 255.0 : (255 - pixel) / 255.0;
+      map.data[y * width + x] = (occupancy > occupied_thresh) ? 100 : ((occupancy < free_thresh) ? 0 : -1);
+    }
+  }
+  return true;
+}
+
+
+/**
+ * @brief Reads queries, one per line as "start_x start_y start_yaw goal_x goal_y goal_yaw" (lines starting with # are skipped)
+ */
+bool loadQueries(const std::string& file_name, const std::string& frame_id, std::vector<Query>& queries)
+{
+  std::ifstream file(file_name.c_str());
+  if(!file)
+  {
+    ROS_ERROR("Could not open query file %s", file_name.c_str());
+    return false;
+  }
+
+  std::string line;
+  while(std::getline(file, line))
+  {
+    if(line.empty() || (line[0] == '#'))
+      continue;
+
+    double values[6];
+    std::istringstream line_stream(line);
+    for(unsigned int i = 0; i < 6; i++)
+    {
+      line_stream >> values[i];
+    }
+    if(!line_stream)
+    {
+      ROS_WARN("Skipping malformed query \"%s\"", line.c_str());
+      continue;
+    }
+
+    Query query;
+    query.start.header.frame_id = frame_id;
+    query.start.pose.position.x = values[0];
+    query.start.pose.position.y = values[1];
+    query.start.pose.orientation = tf::createQuaternionMsgFromYaw(values[2]);
+    query.goal.header.frame_id = frame_id;
+    query.goal.pose.position.x = values[3];
+    query.goal.pose.position.y = values[4];
+    query.goal.pose.orientation = tf::createQuaternionMsgFromYaw(values[5]);
+    queries.push_back(query);
+  }
+  return !queries.empty();
+}
+
+
+/**
+ * @brief Reads recorded requests as queries, each planned on its recorded costmap
+ *        (requests with another geometry of the costmap than the first one are skipped)
+ * @param map Occupancy grid with the geometry of the first request
+ * @param footprint Footprint of the first request
+ */
+bool loadRecords(const std::string& record_files, const std::string& frame_id, nav_msgs::OccupancyGrid& map,
+                 std::vector<geometry_msgs::Point>& footprint, std::vector<Query>& queries)
+{
+  std::vector<std::string> files;
+  std::istringstream file_list(record_files);
+  std::string file;
+  while(std::getline(file_list, file, ';'))
+  {
+    files.push_back(file);
+  }
+
+  ompl_planner_base::RequestReader reader;
+  if(!reader.open(files))
+    return false;
+
+  ompl_planner_base::RecordedRequest request, first_request;
+  std::vector<unsigned char> snapshot_costs;
+  ompl_planner_base::CostmapSnapshotPtr snapshot;
+  unsigned int num_skipped = 0;
+  while(reader.next(request))
+  {
+    if(queries.empty())
+    {
+      first_request = request;
+      ompl_planner_base::recordToMap(request, frame_id, map);
+      footprint = request.footprint;
+    }
+    else if( (request.size_x != first_request.size_x) || (request.size_y != first_request.size_y) ||
+             (request.resolution != first_request.resolution) || (request.origin_x != first_request.origin_x) ||
+             (request.origin_y != first_request.origin_y) )
+    {
+      num_skipped++;
+      continue;
+    }
+
+    // consecutive requests on an unchanged costmap share one snapshot
+    if(!snapshot || (request.costs != snapshot_costs))
+    {
+      snapshot = ompl_planner_base::CostmapSnapshotPtr(new ompl_planner_base::CostmapSnapshot());
+      snapshot->copy(request.getView());
+      snapshot_costs = request.costs;
+    }
+
+    Query query;
+    query.start.header.frame_id = frame_id;
+    query.start.pose.position.x = request.start.x;
+    query.start.pose.position.y = request.start.y;
+    query.start.pose.orientation = tf::createQuaternionMsgFromYaw(request.start.theta);
+    query.goal.header.frame_id = frame_id;
+    query.goal.pose.position.x = request.goal.x;
+    query.goal.pose.position.y = request.goal.y;
+    query.goal.pose.orientation = tf::createQuaternionMsgFromYaw(request.goal.theta);
+    query.snapshot = snapshot;
+    queries.push_back(query);
+  }
+
+  if(num_skipped > 0)
+    ROS_WARN("Skipped %d recorded requests on a costmap of another geometry than the first one", num_skipped);
+  if(queries.empty())
+    ROS_ERROR("No requests recorded in %s", record_files.c_str());
+  return !queries.empty();
+}
+
+
+/**
+ * @brief Runs all queries with one planner configuration, writes one line per run and adds the results to the summary
+ */
+void runPlanner(ompl_planner_base::OMPLPlannerBase& planner, const std::vector<Query>& queries, int runs,
+                std::ofstream& output, PlannerSummary& summary)
+{
+  for(unsigned int i = 0; i < queries.size(); i++)
+  {
+    for(int run = 0; run < runs; run++)
+    {
+      std::vector<geometry_msgs::PoseStamped> plan;
+      if(queries[i].snapshot)
+        planner.setCostmapSnapshot(queries[i].snapshot);
+      const ros::WallTime start_time = ros::WallTime::now();
+      const bool success = planner.makePlan(queries[i].start, queries[i].goal, plan);
+      const double total_time = (ros::WallTime::now() - start_time).toSec();
+
+      // queries rejected before planning publish no diagnostics
+      const ompl_planner_base::OMPLPlannerDiagnostics::ConstPtr diagnostics = planner.getLastDiagnostics();
+      const ompl_planner_base::OMPLPlannerBaseStats::ConstPtr statistics = planner.getLastStatistics();
+      const double solve_time = diagnostics ? diagnostics->planning_time : 0.0;
+      const double simplification_time = diagnostics ? diagnostics->simplification_time : 0.0;
+      const int validity_checks = diagnostics ? diagnostics->validity_check_count : 0;
+      const int motion_checks = diagnostics ? diagnostics->motion_check_count : 0;
+      const double path_length = (success && statistics) ? statistics->path_length : 0.0;
+
+      output << summary.planner << "," << i << "," << run << "," << (success ? 1 : 0) << "," << solve_time << ","
+             << simplification_time << "," << total_time << "," << path_length << "," << validity_checks << "," << motion_checks << "\n";
+
+      summary.runs++;
+      summary.validity_checks.add(validity_checks);
+      if(!success)
+        continue;
+
+      summary.successes++;
+      summary.solve_time.add(solve_time);
+      summary.simplification_time.add(simplification_time);
+      summary.total_time.add(total_time);
+      summary.path_length.add(path_length);
+    }
+  }
+}
+
+
+/**
+ * @brief Logs the summaries and writes them as CSV (if a file is given)
+ */
+void writeSummaries(const std::vector<PlannerSummary>& summaries, const std::string& summary_file)
+{
+  std::ofstream file;
+  if(!summary_file.empty())
+  {
+    file.open(summary_file.c_str());
+    if(!file)
+      ROS_ERROR("Could not open %s to write the summary", summary_file.c_str());
+    file.precision(9);
+    file << "planner,runs,success_rate,solve_time_p50,solve_time_p90,solve_time_p99,simplification_time_p50,simplification_time_p90,"
+         << "simplification_time_p99,total_time_p50,total_time_p90,total_time_p99,path_length_mean,validity_checks_mean\n";
+  }
+
+  for(unsigned int i = 0; i < summaries.size(); i++)
+  {
+    const PlannerSummary& summary = summaries[i];
+    const double success_rate = (summary.runs > 0) ? (double) summary.successes / summary.runs : 0.0;
+    ROS_INFO("%s: %d runs, success rate %.3f, solve time P50/P90/P99 %.4f/%.4f/%.4f s, total time P50/P90/P99 %.4f/%.4f/%.4f s, "
+             "path length %.3f m, %.0f validity checks",
+             summary.planner.c_str(), summary.runs, success_rate,
+             summary.solve_time.getQuantile(0.5), summary.solve_time.getQuantile(0.9), summary.solve_time.getQuantile(0.99),
+             summary.total_time.getQuantile(0.5), summary.total_time.getQuantile(0.9), summary.total_time.getQuantile(0.99),
+             summary.path_length.getMean(), summary.validity_checks.getMean());
+
+    if(!file.is_open())
+      continue;
+
+    const ompl_planner_base::QuantileHistogram* times[] = {&summary.solve_time, &summary.simplification_time, &summary.total_time};
+    file << summary.planner << "," << summary.runs << "," << success_rate;
+    for(unsigned int j = 0; j < 3; j++)
+    {
+      file << "," << times[j]->getQuantile(0.5) << "," << times[j]->getQuantile(0.9) << "," << times[j]->getQuantile(0.99);
+    }
+    file << "," << summary.path_length.getMean() << "," << summary.validity_checks.getMean() << "\n";
+  }
+}
+
+
+/**
+ * Offline benchmark of the planners of the plugin. Loads a map stored by map_server and a file of queries, then solves
+ * every query several times with each planner through makePlan (so all checks and caches of the plugin are included).
+ * The map is published on "map" for the static layer of the costmap configured in ~costmap.
+ * Alternatively the queries are read from the requests recorded by the plugin (~record_files, separated by semicolons),
+ * each one is planned on its recorded costmap and the map only provides the geometry of the costmap. All planners are configured
+ * from ~planner, with global_planner_type overridden by the entries of ~planners (separated by semicolons, so an entry
+ * may be a comma separated portfolio) and replanning switched off. The random seed of ompl is fixed,
+ * so a benchmark with the same map, queries and configuration samples the same sequence of states.
+ */
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "benchmark_planners");
+  ros::NodeHandle private_nh("~");
+
+  std::string map_file, query_file, record_files, output_file, summary_file, planner_list, frame_id;
+  int runs, seed;
+  private_nh.param("map_file", map_file, std::string(""));
+  private_nh.param("query_file", query_file, std::string(""));
+  private_nh.param("record_files", record_files, std::string(""));
+  private_nh.param("output_file", output_file, std::string("benchmark.csv"));
+  private_nh.param("summary_file", summary_file, std::string(""));
+  private_nh.param("planners", planner_list, std::string("EST;KPIECE;LBKPIECE;LazyRRT;pRRT;RRT;RRTConnect;pSBL;SBL;PRM"));
+  private_nh.param("frame_id", frame_id, std::string("map"));
+  private_nh.param("runs", runs, 10);
+  private_nh.param("seed", seed, 1);
+
+  // seed has to be set before the first random number generator of ompl is created
+  ompl::RNG::setSeed(seed);
+
+  nav_msgs::OccupancyGrid map;
+  std::vector<Query> queries;
+  if(!record_files.empty())
+  {
+    // recorded costs were computed with the recorded footprint
+    std::vector<geometry_msgs::Point> footprint;
+    if(!loadRecords(record_files, frame_id, map, footprint, queries))
+      return 1;
+    if(!footprint.empty())
+      private_nh.setParam("costmap/footprint", ompl_planner_base::formatFootprint(footprint));
+  }
+  else if(!loadMap(map_file, frame_id, map) || !loadQueries(query_file, frame_id, queries))
+  {
+    return 1;
+  }
+
+  // costmap gets the map from its static layer
+  ros::NodeHandle nh;
+  ros::Publisher map_pub = nh.advertise<nav_msgs::OccupancyGrid>("map", 1, true);
+  map_pub.publish(map);
+
+  ros::AsyncSpinner spinner(1);
+  spinner.start();
+  tf::TransformListener tf(ros::Duration(10));
+  costmap_2d::Costmap2DROS costmap_ros("costmap", tf);
+
+  const ros::WallTime wait_start_time = ros::WallTime::now();
+  while( ros::ok() && ((costmap_ros.getCostmap()->getSizeInCellsX() != map.info.width) ||
+                       (costmap_ros.getCostmap()->getSizeInCellsY() != map.info.height)) )
+  {
+    if((ros::WallTime::now() - wait_start_time).toSec() > 10.0)
+    {
+      ROS_ERROR("Costmap did not receive the map - is a static layer subscribed to \"map\" configured in ~costmap?");
+      return 1;
+    }
+    ros::WallDuration(0.1).sleep();
+  }
+
+  std::ofstream output(output_file.c_str());
+  if(!output)
+  {
+    ROS_ERROR("Could not open %s to write the results", output_file.c_str());
+    return 1;
+  }
+  output.precision(9);
+  output << "planner,query,run,success,solve_time,simplification_time,total_time,path_length,validity_checks,motion_checks\n";
+
+  // every planner gets its own namespace, starting from the configuration given in ~planner
+  XmlRpc::XmlRpcValue planner_params;
+  const bool has_planner_params = private_nh.getParam("planner", planner_params);
+  std::vector<PlannerSummary> summaries;
+  std::istringstream planners(planner_list);
+  std::string planner_type;
+  while(ros::ok() && std::getline(planners, planner_type, ';'))
+  {
+    std::ostringstream name;
+    name << "planner_" << summaries.size();
+    if(has_planner_params)
+      private_nh.setParam(name.str(), planner_params);
+    private_nh.setParam(name.str() + "/global_planner_type", planner_type);
+    private_nh.setParam(name.str() + "/reuse_last_plan", false);
+    private_nh.setParam(name.str() + "/anytime_planning", false);
+    private_nh.setParam(name.str() + "/publish_diagnostics", true);
+
+    ROS_INFO("Benchmarking %s on %d queries with %d runs each", planner_type.c_str(), (int) queries.size(), runs);
+    ompl_planner_base::OMPLPlannerBase planner(name.str(), &costmap_ros);
+    summaries.push_back(PlannerSummary(planner_type));
+    runPlanner(planner, queries, runs, output, summaries.back());
+  }
+
+  writeSummaries(summaries, summary_file);
+  spinner.stop();
+  return 0;
+}
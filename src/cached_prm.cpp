@@ -0,0 +1,225 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#include <ompl_planner_base/cached_prm.h>
+#include <ompl/base/spaces/SE2StateSpace.h>
+
+// std c++ classes
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+// boost classes
+#include <boost/tuple/tuple.hpp>
+
+
+namespace ompl_planner_base {
+
+  CachedPRM::CachedPRM(const ompl::base::SpaceInformationPtr& si)
+    : ompl::geometric::PRM(si)
+  {
+    setName("CachedPRM");
+  }
+
+
+  unsigned int CachedPRM::invalidateRegion(double min_x, double min_y, double max_x, double max_y)
+  {
+    boost::mutex::scoped_lock lock(graphMutex_);
+
+    std::vector<bool> vertex_detached(boost::num_vertices(g_), false);
+    for(unsigned int i = 0; i < detached_vertices_.size(); i++)
+    {
+      vertex_detached[detached_vertices_[i]] = true;
+    }
+
+    // collect vertices inside the region that became invalid, detached vertices that are valid again are put back
+    std::vector<Vertex> invalid_vertices;
+    std::vector<bool> vertex_invalid(boost::num_vertices(g_), false);
+    boost::graph_traits<Graph>::vertex_iterator vi, vi_end;
+    for(boost::tie(vi, vi_end) = boost::vertices(g_); vi != vi_end; ++vi)
+    {
+      const ompl::base::SE2StateSpace::StateType* state = stateProperty_[*vi]->as<ompl::base::SE2StateSpace::StateType>();
+      if( (state->getX() < min_x) || (state->getX() > max_x) || (state->getY() < min_y) || (state->getY() > max_y) )
+        continue;
+
+      const bool valid = si_->isValid(state);
+      if(vertex_detached[*vi])
+      {
+        if(valid)
+        {
+          attachVertex(*vi);
+          vertex_detached[*vi] = false;
+        }
+      }
+      else if(!valid)
+      {
+        invalid_vertices.push_back(*vi);
+        vertex_invalid[*vi] = true;
+      }
+    }
+
+    std::vector<Vertex> still_detached;
+    for(unsigned int i = 0; i < detached_vertices_.size(); i++)
+    {
+      if(vertex_detached[detached_vertices_[i]])
+        still_detached.push_back(detached_vertices_[i]);
+    }
+    detached_vertices_.swap(still_detached);
+
+    // collect edges passing through the region that became invalid (edges of invalid vertices are dropped anyway)
+    std::vector<std::pair<Vertex, Vertex> > invalid_edges;
+    boost::graph_traits<Graph>::edge_iterator ei, ei_end;
+    for(boost::tie(ei, ei_end) = boost::edges(g_); ei != ei_end; ++ei)
+    {
+      const Vertex u = boost::source(*ei, g_);
+      const Vertex v = boost::target(*ei, g_);
+      if(vertex_invalid[u] || vertex_invalid[v])
+        continue;
+
+      const ompl::base::SE2StateSpace::StateType* state_u = stateProperty_[u]->as<ompl::base::SE2StateSpace::StateType>();
+      const ompl::base::SE2StateSpace::StateType* state_v = stateProperty_[v]->as<ompl::base::SE2StateSpace::StateType>();
+
+      // the straight segment between both vertices lies within their bounding box
+      if( (std::max(state_u->getX(), state_v->getX()) < min_x) || (std::min(state_u->getX(), state_v->getX()) > max_x) ||
+          (std::max(state_u->getY(), state_v->getY()) < min_y) || (std::min(state_u->getY(), state_v->getY()) > max_y) )
+        continue;
+
+      if(!si_->checkMotion(state_u, state_v))
+        invalid_edges.push_back(std::make_pair(u, v));
+    }
+
+    // now remove them -> vertex descriptors stay valid as no vertex is removed from the graph
+    unsigned int num_removed_edges = invalid_edges.size();
+    for(unsigned int i = 0; i < invalid_vertices.size(); i++)
+    {
+      num_removed_edges += boost::out_degree(invalid_vertices[i], g_);
+      detachVertex(invalid_vertices[i]);
+    }
+    for(unsigned int i = 0; i < invalid_edges.size(); i++)
+    {
+      boost::remove_edge(invalid_edges[i].first, invalid_edges[i].second, g_);
+    }
+
+    if(num_removed_edges > 0)
+      rebuildComponents();
+
+    return num_removed_edges;
+  }
+
+
+  unsigned int CachedPRM::loadRoadmap(const ompl::base::PlannerData& data)
+  {
+    boost::mutex::scoped_lock lock(graphMutex_);
+
+    // add vertices the same way the PRM adds its milestones, but without trying to connect them
+    std::vector<Vertex> vertices(data.numVertices());
+    for(unsigned int i = 0; i < data.numVertices(); i++)
+    {
+      Vertex m = boost::add_vertex(g_);
+      stateProperty_[m] = si_->cloneState(data.getVertex(i).getState());
+      totalConnectionAttemptsProperty_[m] = 1;
+      successfulConnectionAttemptsProperty_[m] = 0;
+      disjointSets_.make_set(m);
+      nn_->add(m);
+      vertices[i] = m;
+    }
+
+    // edges are stored in both directions -> only add them once
+    std::vector<unsigned int> edge_list;
+    for(unsigned int i = 0; i < data.numVertices(); i++)
+    {
+      data.getEdges(i, edge_list);
+      for(unsigned int j = 0; j < edge_list.size(); j++)
+      {
+        const Vertex u = vertices[i];
+        const Vertex v = vertices[edge_list[j]];
+        if(boost::edge(u, v, g_).second)
+          continue;
+
+        const ompl::base::Cost weight = opt_->motionCost(stateProperty_[u], stateProperty_[v]);
+        const Graph::edge_property_type properties(weight);
+        boost::add_edge(u, v, properties, g_);
+        uniteComponents(u, v);
+      }
+    }
+
+    return vertices.size();
+  }
+
+
+  void CachedPRM::clear()
+  {
+    ompl::geometric::PRM::clear();
+    detached_vertices_.clear();
+  }
+
+
+  void CachedPRM::detachVertex(Vertex v)
+  {
+    // the PRM never checks the neighbor side of a new connection and bounces from vertices without checking them,
+    // so an invalid vertex may neither be a neighbor candidate nor be picked by the expansion
+    boost::clear_vertex(v, g_);
+    nn_->remove(v);
+    successfulConnectionAttemptsProperty_[v] = totalConnectionAttemptsProperty_[v];
+    detached_vertices_.push_back(v);
+  }
+
+
+  void CachedPRM::attachVertex(Vertex v)
+  {
+    nn_->add(v);
+    successfulConnectionAttemptsProperty_[v] = 0;
+  }
+
+
+  void CachedPRM::rebuildComponents()
+  {
+    // disjoint sets can not be split -> recompute them from scratch
+    boost::graph_traits<Graph>::vertex_iterator vi, vi_end;
+    for(boost::tie(vi, vi_end) = boost::vertices(g_); vi != vi_end; ++vi)
+    {
+      disjointSets_.make_set(*vi);
+    }
+
+    boost::graph_traits<Graph>::edge_iterator ei, ei_end;
+    for(boost::tie(ei, ei_end) = boost::edges(g_); ei != ei_end; ++ei)
+    {
+      disjointSets_.union_set(boost::source(*ei, g_), boost::target(*ei, g_));
+    }
+  }
+
+}
@@ -0,0 +1,231 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#include <ompl_planner_base/coarse_grid_planner.h>
+#include <ompl_planner_base/connectivity_index.h>
+
+// std c++ classes
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <math.h>
+
+
+namespace ompl_planner_base {
+
+  CoarseGridPlanner::CoarseGridPlanner()
+    : size_x_(0), size_y_(0), resolution_(0.0), origin_x_(0.0), origin_y_(0.0), current_stamp_(0){}
+
+
+  void CoarseGridPlanner::update(const CostmapView& costmap, unsigned int factor)
+  {
+    factor = std::max(factor, 1u);
+    const unsigned int fine_size_x = costmap.getSizeInCellsX();
+    const unsigned int fine_size_y = costmap.getSizeInCellsY();
+
+    size_x_ = (fine_size_x + factor - 1) / factor;
+    size_y_ = (fine_size_y + factor - 1) / factor;
+    resolution_ = costmap.getResolution() * factor;
+    origin_x_ = costmap.getOriginX();
+    origin_y_ = costmap.getOriginY();
+
+    // max-pooling -> a coarse cell is blocked as soon as one of its cells is
+    blocked_.assign(size_x_ * size_y_, 0);
+    const unsigned char* charmap = costmap.getCharMap();
+    for(unsigned int fy = 0; fy < fine_size_y; fy++)
+    {
+      const unsigned char* row = charmap + fy * fine_size_x;
+      unsigned char* coarse_row = &blocked_[(fy / factor) * size_x_];
+      for(unsigned int fx = 0; fx < fine_size_x; fx++)
+      {
+        if(!ConnectivityIndex::isFreeCost(row[fx]))
+          coarse_row[fx / factor] = 1;
+      }
+    }
+
+    if(cost_.size() != blocked_.size())
+    {
+      cost_.resize(blocked_.size());
+      parent_.resize(blocked_.size());
+      stamp_.assign(blocked_.size(), 0);
+      current_stamp_ = 0;
+    }
+  }
+
+
+  bool CoarseGridPlanner::worldToGrid(double wx, double wy, unsigned int& gx, unsigned int& gy) const
+  {
+    if( (wx < origin_x_) || (wy < origin_y_) )
+      return false;
+
+    gx = (unsigned int) ((wx - origin_x_) / resolution_);
+    gy = (unsigned int) ((wy - origin_y_) / resolution_);
+    return (gx < size_x_) && (gy < size_y_);
+  }
+
+
+  bool CoarseGridPlanner::plan(double start_x, double start_y, double goal_x, double goal_y, std::vector<unsigned int>& path)
+  {
+    path.clear();
+
+    unsigned int start_gx, start_gy, goal_gx, goal_gy;
+    if(!worldToGrid(start_x, start_y, start_gx, start_gy) || !worldToGrid(goal_x, goal_y, goal_gx, goal_gy))
+      return false;
+
+    // new stamp marks all cells as unvisited (reset on overflow)
+    current_stamp_++;
+    if(current_stamp_ == 0)
+    {
+      std::fill(stamp_.begin(), stamp_.end(), 0);
+      current_stamp_ = 1;
+    }
+
+    const unsigned int start = start_gy * size_x_ + start_gx;
+    const unsigned int goal = goal_gy * size_x_ + goal_gx;
+    const float diagonal = (float) M_SQRT2;
+
+    typedef std::pair<float, unsigned int> QueueEntry;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> > open;
+
+    cost_[start] = 0.0f;
+    parent_[start] = start;
+    stamp_[start] = current_stamp_;
+    open.push(QueueEntry(0.0f, start));
+
+    bool found = false;
+    while(!open.empty())
+    {
+      const QueueEntry entry = open.top();
+      open.pop();
+      const unsigned int index = entry.second;
+      if(index == goal)
+      {
+        found = true;
+        break;
+      }
+
+      const unsigned int gx = index % size_x_;
+      const unsigned int gy = index / size_x_;
+
+      // octile distance to the goal as heuristic -> skip entries of cells reached cheaper since they were queued
+      const unsigned int hx = std::max(gx, goal_gx) - std::min(gx, goal_gx);
+      const unsigned int hy = std::max(gy, goal_gy) - std::min(gy, goal_gy);
+      const float heuristic = std::max(hx, hy) + (diagonal - 1.0f) * std::min(hx, hy);
+      if(entry.first > cost_[index] + heuristic + 1e-3f)
+        continue;
+
+      for(int dy = -1; dy <= 1; dy++)
+      {
+        for(int dx = -1; dx <= 1; dx++)
+        {
+          const int nx = (int) gx + dx;
+          const int ny = (int) gy + dy;
+          if( ((dx == 0) && (dy == 0)) || (nx < 0) || (ny < 0) || (nx >= (int) size_x_) || (ny >= (int) size_y_) )
+            continue;
+
+          const unsigned int neighbor = ny * size_x_ + nx;
+          if(blocked_[neighbor] && (neighbor != goal))
+            continue;
+
+          // no diagonal steps between two blocked cells
+          if( (dx != 0) && (dy != 0) && (blocked_[gy * size_x_ + nx] || blocked_[ny * size_x_ + gx]) )
+            continue;
+
+          const float cost = cost_[index] + (((dx != 0) && (dy != 0)) ? diagonal : 1.0f);
+          if( (stamp_[neighbor] == current_stamp_) && (cost >= cost_[neighbor]) )
+            continue;
+
+          cost_[neighbor] = cost;
+          parent_[neighbor] = index;
+          stamp_[neighbor] = current_stamp_;
+
+          const unsigned int nhx = std::max((unsigned int) nx, goal_gx) - std::min((unsigned int) nx, goal_gx);
+          const unsigned int nhy = std::max((unsigned int) ny, goal_gy) - std::min((unsigned int) ny, goal_gy);
+          open.push(QueueEntry(cost + std::max(nhx, nhy) + (diagonal - 1.0f) * std::min(nhx, nhy), neighbor));
+        }
+      }
+    }
+
+    if(!found)
+      return false;
+
+    for(unsigned int index = goal; index != start; index = parent_[index])
+    {
+      path.push_back(index);
+    }
+    path.push_back(start);
+    std::reverse(path.begin(), path.end());
+    return true;
+  }
+
+
+  void CoarseGridPlanner::getCorridor(const std::vector<unsigned int>& path, double width, Corridor& corridor)
+  {
+    corridor.clear();
+    corridor.cell_size = resolution_;
+
+    // stamp marks the cells already added
+    current_stamp_++;
+    if(current_stamp_ == 0)
+    {
+      std::fill(stamp_.begin(), stamp_.end(), 0);
+      current_stamp_ = 1;
+    }
+
+    const int radius = (int) ceil(width / resolution_);
+    for(unsigned int i = 0; i < path.size(); i++)
+    {
+      const int gx = path[i] % size_x_;
+      const int gy = path[i] / size_x_;
+      for(int ny = std::max(gy - radius, 0); ny <= std::min(gy + radius, (int) size_y_ - 1); ny++)
+      {
+        for(int nx = std::max(gx - radius, 0); nx <= std::min(gx + radius, (int) size_x_ - 1); nx++)
+        {
+          const unsigned int index = ny * size_x_ + nx;
+          if(stamp_[index] == current_stamp_)
+            continue;
+
+          stamp_[index] = current_stamp_;
+          corridor.cells_x.push_back(origin_x_ + nx * resolution_);
+          corridor.cells_y.push_back(origin_y_ + ny * resolution_);
+        }
+      }
+    }
+  }
+
+}
@@ -0,0 +1,271 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#include <ompl_planner_base/connectivity_index.h>
+
+// std c++ classes
+#include <algorithm>
+
+
+namespace ompl_planner_base {
+
+  ConnectivityIndex::ConnectivityIndex() : size_x_(0), size_y_(0){}
+
+
+  void ConnectivityIndex::build(const CostmapView& costmap)
+  {
+    size_x_ = costmap.getSizeInCellsX();
+    size_y_ = costmap.getSizeInCellsY();
+    const unsigned int num_cells = size_x_ * size_y_;
+    parent_.resize(num_cells);
+    free_.resize(num_cells);
+
+    const unsigned char* charmap = costmap.getCharMap();
+    for(unsigned int i = 0; i < num_cells; i++)
+    {
+      parent_[i] = i;
+      free_[i] = isFreeCost(charmap[i]);
+    }
+
+    // one pass suffices -> every pair of neighbours is joined when the later of both cells is visited
+    for(unsigned int my = 0; my < size_y_; my++)
+    {
+      for(unsigned int mx = 0; mx < size_x_; mx++)
+      {
+        const unsigned int index = my * size_x_ + mx;
+        if(!free_[index])
+          continue;
+
+        if((mx > 0) && free_[index - 1])
+          unite(index, index - 1);
+        if(my == 0)
+          continue;
+        if((mx > 0) && free_[index - size_x_ - 1])
+          unite(index, index - size_x_ - 1);
+        if(free_[index - size_x_])
+          unite(index, index - size_x_);
+        if((mx + 1 < size_x_) && free_[index - size_x_ + 1])
+          unite(index, index - size_x_ + 1);
+      }
+    }
+  }
+
+
+  bool ConnectivityIndex::update(const CostmapView& costmap, unsigned int min_x, unsigned int min_y, unsigned int max_x, unsigned int max_y)
+  {
+    if(!isValid() || (costmap.getSizeInCellsX() != size_x_) || (costmap.getSizeInCellsY() != size_y_))
+    {
+      build(costmap);
+      return false;
+    }
+
+    max_x = std::min(max_x, size_x_ - 1);
+    max_y = std::min(max_y, size_y_ - 1);
+
+    // a blocked cell may split a component -> union-find alone only handles cells which became free
+    const unsigned char* charmap = costmap.getCharMap();
+    bool blocked = false;
+    for(unsigned int my = min_y; (my <= max_y) && !blocked; my++)
+    {
+      for(unsigned int mx = min_x; mx <= max_x; mx++)
+      {
+        const unsigned int index = my * size_x_ + mx;
+        if(free_[index] && !isFreeCost(charmap[index]))
+        {
+          blocked = true;
+          break;
+        }
+      }
+    }
+
+    if(!blocked)
+    {
+      // merge the cells which became free with their free neighbours
+      for(unsigned int my = min_y; my <= max_y; my++)
+      {
+        for(unsigned int mx = min_x; mx <= max_x; mx++)
+        {
+          const unsigned int index = my * size_x_ + mx;
+          if(!free_[index] && isFreeCost(charmap[index]))
+          {
+            free_[index] = 1;
+            uniteWithNeighbors(mx, my);
+          }
+        }
+      }
+      return true;
+    }
+
+    // a blocked cell may split a component -> relabel the components touching the region
+    for(unsigned int my = min_y; my <= max_y; my++)
+    {
+      for(unsigned int mx = min_x; mx <= max_x; mx++)
+      {
+        const unsigned int index = my * size_x_ + mx;
+        free_[index] = isFreeCost(charmap[index]);
+        parent_[index] = index;
+      }
+    }
+    relabelAround(min_x, min_y, max_x, max_y);
+    return true;
+  }
+
+
+  void ConnectivityIndex::reset()
+  {
+    parent_.clear();
+    free_.clear();
+    visited_.clear();
+    open_.clear();
+    size_x_ = 0;
+    size_y_ = 0;
+  }
+
+
+  bool ConnectivityIndex::connected(unsigned int start_x, unsigned int start_y, unsigned int goal_x, unsigned int goal_y)
+  {
+    if( (start_x >= size_x_) || (start_y >= size_y_) || (goal_x >= size_x_) || (goal_y >= size_y_) )
+      return true;
+
+    const unsigned int start_index = start_y * size_x_ + start_x;
+    const unsigned int goal_index = goal_y * size_x_ + goal_x;
+    if(!free_[start_index] || !free_[goal_index])
+      return true;
+
+    return find(start_index) == find(goal_index);
+  }
+
+
+  unsigned int ConnectivityIndex::find(unsigned int index)
+  {
+    // path halving -> every other cell on the way points to its grandparent afterwards
+    while(parent_[index] != index)
+    {
+      parent_[index] = parent_[parent_[index]];
+      index = parent_[index];
+    }
+    return index;
+  }
+
+
+  void ConnectivityIndex::unite(unsigned int index_a, unsigned int index_b)
+  {
+    const unsigned int root_a = find(index_a);
+    const unsigned int root_b = find(index_b);
+
+    // smaller index becomes the root -> trees stay shallow for the row-wise scan in build
+    if(root_a < root_b)
+      parent_[root_b] = root_a;
+    else if(root_b < root_a)
+      parent_[root_a] = root_b;
+  }
+
+
+  void ConnectivityIndex::relabelAround(unsigned int min_x, unsigned int min_y, unsigned int max_x, unsigned int max_y)
+  {
+    // every piece of a component which lost cells has a cell next to the region -> seed from the region and its border
+    // (pieces reached through cells which became free are relabeled along, the other components keep their labels)
+    const unsigned int seed_min_x = (min_x > 0) ? min_x - 1 : 0;
+    const unsigned int seed_min_y = (min_y > 0) ? min_y - 1 : 0;
+    const unsigned int seed_max_x = std::min(max_x + 1, size_x_ - 1);
+    const unsigned int seed_max_y = std::min(max_y + 1, size_y_ - 1);
+
+    if(visited_.size() != parent_.size())
+      visited_.assign(parent_.size(), 0);
+    open_.clear();
+    for(unsigned int my = seed_min_y; my <= seed_max_y; my++)
+    {
+      for(unsigned int mx = seed_min_x; mx <= seed_max_x; mx++)
+      {
+        const unsigned int seed = my * size_x_ + mx;
+        if(!free_[seed] || visited_[seed])
+          continue;
+
+        // flood fill the piece of the seed, all its cells point to the seed afterwards
+        visited_[seed] = 1;
+        open_.push_back(seed);
+        for(unsigned int next = open_.size() - 1; next < open_.size(); next++)
+        {
+          const unsigned int index = open_[next];
+          parent_[index] = seed;
+
+          const unsigned int cx = index % size_x_;
+          const unsigned int cy = index / size_x_;
+          for(unsigned int ny = (cy > 0) ? cy - 1 : 0; ny <= std::min(cy + 1, size_y_ - 1); ny++)
+          {
+            for(unsigned int nx = (cx > 0) ? cx - 1 : 0; nx <= std::min(cx + 1, size_x_ - 1); nx++)
+            {
+              const unsigned int neighbor = ny * size_x_ + nx;
+              if(free_[neighbor] && !visited_[neighbor])
+              {
+                visited_[neighbor] = 1;
+                open_.push_back(neighbor);
+              }
+            }
+          }
+        }
+      }
+    }
+
+    // open_ holds every cell filled -> only those are cleared
+    for(unsigned int i = 0; i < open_.size(); i++)
+    {
+      visited_[open_[i]] = 0;
+    }
+  }
+
+
+  void ConnectivityIndex::uniteWithNeighbors(unsigned int mx, unsigned int my)
+  {
+    const unsigned int index = my * size_x_ + mx;
+    for(int dy = -1; dy <= 1; dy++)
+    {
+      for(int dx = -1; dx <= 1; dx++)
+      {
+        const int nx = (int) mx + dx;
+        const int ny = (int) my + dy;
+        if( ((dx == 0) && (dy == 0)) || (nx < 0) || (ny < 0) || (nx >= (int) size_x_) || (ny >= (int) size_y_) )
+          continue;
+
+        const unsigned int neighbor = ny * size_x_ + nx;
+        if(free_[neighbor])
+          unite(index, neighbor);
+      }
+    }
+  }
+
+}
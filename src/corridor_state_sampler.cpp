@@ -0,0 +1,90 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#include <ompl_planner_base/corridor_state_sampler.h>
+
+// ompl planner specific classes
+#include <ompl/base/spaces/SE2StateSpace.h>
+
+// std c++ classes
+#include <math.h>
+
+
+namespace ompl_planner_base {
+
+  CorridorStateSampler::CorridorStateSampler(const ompl::base::StateSpace* space, const CorridorPtr& corridor)
+    : ompl::base::StateSampler(space), corridor_(corridor), default_sampler_(space->allocDefaultStateSampler()){}
+
+
+  void CorridorStateSampler::sampleUniform(ompl::base::State* state)
+  {
+    const Corridor& corridor = *corridor_;
+    if(corridor.empty() || (rng_.uniform01() >= corridor.bias))
+    {
+      default_sampler_->sampleUniform(state);
+      return;
+    }
+
+    const unsigned int cell = rng_.uniformInt(0, corridor.cells_x.size() - 1);
+    ompl::base::SE2StateSpace::StateType* se2_state = state->as<ompl::base::SE2StateSpace::StateType>();
+    se2_state->setX(corridor.cells_x[cell] + rng_.uniformReal(0.0, corridor.cell_size));
+    se2_state->setY(corridor.cells_y[cell] + rng_.uniformReal(0.0, corridor.cell_size));
+    se2_state->setYaw(rng_.uniformReal(-M_PI, M_PI));
+
+    // cells at the border of the map may reach beyond the bounds
+    space_->enforceBounds(state);
+  }
+
+
+  void CorridorStateSampler::sampleUniformNear(ompl::base::State* state, const ompl::base::State* near, double distance)
+  {
+    default_sampler_->sampleUniformNear(state, near, distance);
+  }
+
+
+  void CorridorStateSampler::sampleGaussian(ompl::base::State* state, const ompl::base::State* mean, double std_dev)
+  {
+    default_sampler_->sampleGaussian(state, mean, std_dev);
+  }
+
+
+  ompl::base::StateSamplerPtr allocCorridorStateSampler(const ompl::base::StateSpace* space, const CorridorPtr& corridor)
+  {
+    return ompl::base::StateSamplerPtr(new CorridorStateSampler(space, corridor));
+  }
+
+}
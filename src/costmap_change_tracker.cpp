@@ -0,0 +1,135 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#include <ompl_planner_base/costmap_change_tracker.h>
+
+// std c++ classes
+#include <string.h>
+#include <algorithm>
+
+
+namespace ompl_planner_base {
+
+  CostmapChangeTracker::CostmapChangeTracker()
+    : size_x_(0), size_y_(0), resolution_(0.0), origin_x_(0.0), origin_y_(0.0),
+      changed_(false), min_x_(0), min_y_(0), max_x_(0), max_y_(0){}
+
+
+  bool CostmapChangeTracker::update(costmap_2d::Costmap2D& costmap)
+  {
+    boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*(costmap.getMutex()));
+    return update(CostmapView(costmap));
+  }
+
+
+  bool CostmapChangeTracker::update(const CostmapView& costmap)
+  {
+    const unsigned int size_x = costmap.getSizeInCellsX();
+    const unsigned int size_y = costmap.getSizeInCellsY();
+    const unsigned char* charmap = costmap.getCharMap();
+
+    // without a copy of the same map geometry there is nothing to compare against -> take a fresh copy
+    if( reference_.empty() || (size_x != size_x_) || (size_y != size_y_) ||
+        (costmap.getResolution() != resolution_) || (costmap.getOriginX() != origin_x_) || (costmap.getOriginY() != origin_y_) )
+    {
+      size_x_ = size_x;
+      size_y_ = size_y;
+      resolution_ = costmap.getResolution();
+      origin_x_ = costmap.getOriginX();
+      origin_y_ = costmap.getOriginY();
+      reference_.assign(charmap, charmap + size_x * size_y);
+
+      changed_ = true;
+      min_x_ = 0;
+      min_y_ = 0;
+      max_x_ = size_x_ - 1;
+      max_y_ = size_y_ - 1;
+      return false;
+    }
+
+    changed_ = false;
+    for(unsigned int y = 0; y < size_y_; y++)
+    {
+      unsigned char* reference_row = &reference_[y * size_x_];
+      const unsigned char* row = charmap + y * size_x_;
+
+      if(memcmp(reference_row, row, size_x_) == 0)
+        continue;
+
+      // find first and last changed cell of this row
+      unsigned int first = 0;
+      while(reference_row[first] == row[first])
+        first++;
+      unsigned int last = size_x_ - 1;
+      while(reference_row[last] == row[last])
+        last--;
+
+      if(!changed_)
+      {
+        changed_ = true;
+        min_x_ = first;
+        max_x_ = last;
+        min_y_ = y;
+      }
+      min_x_ = std::min(min_x_, first);
+      max_x_ = std::max(max_x_, last);
+      max_y_ = y;
+
+      memcpy(reference_row + first, row + first, last - first + 1);
+    }
+
+    return true;
+  }
+
+
+  void CostmapChangeTracker::getChangedBounds(unsigned int& min_x, unsigned int& min_y,
+                                              unsigned int& max_x, unsigned int& max_y) const
+  {
+    min_x = min_x_;
+    min_y = min_y_;
+    max_x = max_x_;
+    max_y = max_y_;
+  }
+
+
+  void CostmapChangeTracker::reset()
+  {
+    reference_.clear();
+    changed_ = false;
+  }
+
+}
@@ -0,0 +1,184 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#include <ompl_planner_base/costmap_motion_validator.h>
+#include <ompl/base/spaces/SE2StateSpace.h>
+#include <angles/angles.h>
+
+// std c++ classes
+#include <math.h>
+#include <algorithm>
+
+
+namespace ompl_planner_base {
+
+  CostmapMotionValidator::CostmapMotionValidator(ompl::base::SpaceInformation* si)
+    : ompl::base::MotionValidator(si), circumscribed_radius_(0.0), lookup_table_(NULL){}
+
+
+  void CostmapMotionValidator::setCostmap(const CostmapView& costmap, double circumscribed_radius,
+                                          const FootprintLookupTable* lookup_table)
+  {
+    costmap_ = costmap;
+    circumscribed_radius_ = circumscribed_radius;
+    lookup_table_ = lookup_table;
+  }
+
+
+  unsigned int CostmapMotionValidator::getStepCount(const ompl::base::State* s1, const ompl::base::State* s2) const
+  {
+    const ompl::base::SE2StateSpace::StateType* from = s1->as<ompl::base::SE2StateSpace::StateType>();
+    const ompl::base::SE2StateSpace::StateType* to = s2->as<ompl::base::SE2StateSpace::StateType>();
+
+    // distance moved by the center and by the point of the footprint furthest away from it
+    const double dx = to->getX() - from->getX();
+    const double dy = to->getY() - from->getY();
+    const double translation = sqrt(dx*dx + dy*dy);
+    const double rotation = fabs(angles::shortest_angular_distance(from->getYaw(), to->getYaw())) * circumscribed_radius_;
+
+    const double cells = std::max(translation, rotation) / costmap_.getResolution();
+    return std::max(1u, (unsigned int) ceil(cells));
+  }
+
+
+  bool CostmapMotionValidator::getCellKey(const ompl::base::State* state, unsigned int& cell_index, unsigned int& yaw_bin) const
+  {
+    const ompl::base::SE2StateSpace::StateType* se2_state = state->as<ompl::base::SE2StateSpace::StateType>();
+
+    unsigned int cell_x, cell_y;
+    if(!costmap_.worldToMap(se2_state->getX(), se2_state->getY(), cell_x, cell_y))
+      return false;
+
+    cell_index = costmap_.getIndex(cell_x, cell_y);
+    yaw_bin = lookup_table_->getYawBin(se2_state->getYaw());
+    return true;
+  }
+
+
+  unsigned int CostmapMotionValidator::checkSteps(const ompl::base::State* s1, const ompl::base::State* s2,
+                                                  unsigned int steps, ompl::base::State* work) const
+  {
+    const ompl::base::StateSpacePtr& space = si_->getStateSpace();
+    const bool skip_duplicates = (lookup_table_ != NULL) && lookup_table_->isInitialized();
+
+    unsigned int last_cell = 0, last_yaw_bin = 0;
+    bool have_last = skip_duplicates && getCellKey(s1, last_cell, last_yaw_bin);
+
+    // walk from s1 towards s2 -> consecutive samples mostly fall into the same cells and can be skipped
+    for(unsigned int i = 1; i < steps; i++)
+    {
+      space->interpolate(s1, s2, (double) i / (double) steps, work);
+
+      if(skip_duplicates)
+      {
+        unsigned int cell, yaw_bin;
+        if(getCellKey(work, cell, yaw_bin))
+        {
+          if(have_last && (cell == last_cell) && (yaw_bin == last_yaw_bin))
+            continue;
+          last_cell = cell;
+          last_yaw_bin = yaw_bin;
+          have_last = true;
+        }
+        else
+        {
+          have_last = false;
+        }
+      }
+
+      if(!si_->isValid(work))
+        return i;
+    }
+
+    return steps;
+  }
+
+
+  bool CostmapMotionValidator::checkMotion(const ompl::base::State* s1, const ompl::base::State* s2) const
+  {
+    // check end of motion first -> most invalid motions are detected without sampling
+    if(!si_->isValid(s2))
+    {
+      invalid_++;
+      return false;
+    }
+
+    const unsigned int steps = getStepCount(s1, s2);
+    bool result = true;
+    if(steps > 1)
+    {
+      ompl::base::State* work = si_->allocState();
+      result = (checkSteps(s1, s2, steps, work) == steps);
+      si_->freeState(work);
+    }
+
+    if(result)
+      valid_++;
+    else
+      invalid_++;
+
+    return result;
+  }
+
+
+  bool CostmapMotionValidator::checkMotion(const ompl::base::State* s1, const ompl::base::State* s2,
+                                           std::pair<ompl::base::State*, double>& last_valid) const
+  {
+    const ompl::base::StateSpacePtr& space = si_->getStateSpace();
+    const unsigned int steps = getStepCount(s1, s2);
+
+    ompl::base::State* work = si_->allocState();
+    unsigned int first_invalid = checkSteps(s1, s2, steps, work);
+    si_->freeState(work);
+
+    // all interior samples valid -> motion is valid if its end is
+    if( (first_invalid == steps) && si_->isValid(s2) )
+    {
+      valid_++;
+      return true;
+    }
+
+    // report the last valid sample before the first invalid one
+    last_valid.second = (double) (first_invalid - 1) / (double) steps;
+    if(last_valid.first)
+      space->interpolate(s1, s2, last_valid.second, last_valid.first);
+    invalid_++;
+
+    return false;
+  }
+
+}
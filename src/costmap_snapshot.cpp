@@ -0,0 +1,150 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#include <ompl_planner_base/costmap_snapshot.h>
+
+// std c++ classes
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <new>
+
+
+namespace ompl_planner_base {
+
+  CostmapSnapshot::CostmapSnapshot()
+    : data_(NULL), capacity_(0), size_x_(0), size_y_(0), resolution_(0.0), origin_x_(0.0), origin_y_(0.0){}
+
+
+  CostmapSnapshot::~CostmapSnapshot()
+  {
+    free(data_);
+  }
+
+
+  void CostmapSnapshot::copy(costmap_2d::Costmap2D& costmap)
+  {
+    // size of map is only read under lock below -> clipping takes care of the upper bounds
+    copy(costmap, 0, 0, (unsigned int) -1, (unsigned int) -1);
+  }
+
+
+  void CostmapSnapshot::copy(costmap_2d::Costmap2D& costmap,
+                             unsigned int min_x, unsigned int min_y, unsigned int max_x, unsigned int max_y)
+  {
+    boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*(costmap.getMutex()));
+
+    const unsigned int map_size_x = costmap.getSizeInCellsX();
+    const unsigned int map_size_y = costmap.getSizeInCellsY();
+
+    // clip region to map
+    max_x = std::min(max_x, map_size_x - 1);
+    max_y = std::min(max_y, map_size_y - 1);
+    if( (map_size_x == 0) || (map_size_y == 0) || (min_x > max_x) || (min_y > max_y) )
+    {
+      size_x_ = 0;
+      size_y_ = 0;
+      return;
+    }
+
+    size_x_ = max_x - min_x + 1;
+    size_y_ = max_y - min_y + 1;
+    resolution_ = costmap.getResolution();
+    origin_x_ = costmap.getOriginX() + min_x * resolution_;
+    origin_y_ = costmap.getOriginY() + min_y * resolution_;
+
+    const size_t size = (size_t) size_x_ * size_y_;
+    reserve(size);
+
+    const unsigned char* charmap = costmap.getCharMap();
+    if(size_x_ == map_size_x)
+    {
+      // full rows -> region is one block of memory
+      memcpy(data_, charmap + (size_t) min_y * map_size_x, size);
+    }
+    else
+    {
+      for(unsigned int y = 0; y < size_y_; y++)
+      {
+        memcpy(data_ + (size_t) y * size_x_, charmap + (size_t) (min_y + y) * map_size_x + min_x, size_x_);
+      }
+    }
+  }
+
+
+  void CostmapSnapshot::copy(const CostmapView& view)
+  {
+    size_x_ = view.isValid() ? view.getSizeInCellsX() : 0;
+    size_y_ = view.isValid() ? view.getSizeInCellsY() : 0;
+    resolution_ = view.getResolution();
+    origin_x_ = view.getOriginX();
+    origin_y_ = view.getOriginY();
+
+    const size_t size = (size_t) size_x_ * size_y_;
+    reserve(size);
+    if(size > 0)
+      memcpy(data_, view.getCharMap(), size);
+  }
+
+
+  void CostmapSnapshot::reserve(size_t size)
+  {
+    // only reallocate if the buffer is too small
+    if(size <= capacity_)
+      return;
+
+    free(data_);
+    data_ = NULL;
+    capacity_ = 0;
+
+    void* buffer = NULL;
+    if(posix_memalign(&buffer, CACHE_LINE_SIZE, size) != 0)
+      throw std::bad_alloc();
+    data_ = static_cast<unsigned char*>(buffer);
+    capacity_ = size;
+  }
+
+
+  CostmapView CostmapSnapshot::getView() const
+  {
+    if( (size_x_ == 0) || (size_y_ == 0) )
+      return CostmapView();
+
+    return CostmapView(data_, size_x_, size_y_, resolution_, origin_x_, origin_y_);
+  }
+
+}
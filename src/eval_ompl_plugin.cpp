@@ -40,16 +40,55 @@
 // ros sandbox classes
 #include <ompl_planner_base/OMPLPlannerBaseStats.h>
 #include <ompl_planner_base/OMPLPlannerDiagnostics.h>
+#include <ompl_planner_base/streaming_statistics.h>
 
 // std c++ classes
 #include <math.h>
 #include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <string>
+
+
+/**
+ * @brief Streaming statistics of one value of the received messages, over the whole run and over the current report window
+ */
+struct Metric
+{
+  std::string key; // name in the summary file
+  std::string description; // name in the log
+  bool with_quantiles;
+  ompl_planner_base::RunningStatistics total, window;
+  ompl_planner_base::QuantileHistogram total_histogram, window_histogram;
+
+  Metric(const std::string& metric_key, const std::string& metric_description, bool quantiles)
+    : key(metric_key), description(metric_description), with_quantiles(quantiles){}
+
+  void add(double value)
+  {
+    total.add(value);
+    window.add(value);
+    if(with_quantiles)
+    {
+      total_histogram.add(value);
+      window_histogram.add(value);
+    }
+  }
+
+  void resetWindow()
+  {
+    window.reset();
+    window_histogram.reset();
+  }
+};
 
 
 /**
  * @class NodeClass
  * @brief This implements a simple Node for evaluation of the ompl_planner_plugin. The node listens to the statistics_ompl and diagnostics_ompl
- *  topics and calcs some refernce values (mean, root-mean-square (rms-)deviation, ...)
+ *  topics and calcs some refernce values (mean, standard deviation, percentiles of the planning times, ...)
+ *  Memory is constant, so the node may run for long soak tests. Statistics are logged periodically for the last report window
+ *  and the whole run, and written to a CSV (or JSON) file at shutdown.
  */
 class NodeClass
 {
@@ -61,43 +100,40 @@ public:
   ros::Subscriber topic_sub_diagnostics_; // receives diagnostics considering the ompl planner
   ros::Subscriber topic_sub_statistics_; // some values additional to diagnostics considering the plugin
 
-  // member variables
+  // periodic report
+  ros::WallTimer report_timer_;
+  double report_interval_; // duration of a report window [s]
+  std::string output_file_; // file the summary is written to at shutdown (empty -> none, *.json -> JSON, CSV otherwise)
 
   // general
   int num_plan_success_, num_plan_request_; // number of plan querries and successfeul planning attempts
-  std::string planner_name_;
+  int num_window_success_, num_window_request_; // same for the current report window
+  int num_statistics_; // number of received statistics msgs (should match num_plan_success_)
 
   // diagnostics topic
-  std::vector<double> planning_time_; // time ompl needed to find a path
-  std::vector<double> trajectory_size_; // number of frames in the trajectory (0 if no path found)
-  std::vector<double> state_allocator_size_; // number of seeds generated for the state during planning
+  Metric planning_time_; // time ompl needed to find a path
+  Metric trajectory_size_; // number of frames in the trajectory (0 if no path found)
+  Metric state_allocator_size_; // peak memory of the states during planning (bytes)
 
   // statistics topic
-  std::vector<double> start_goal_dist_; // direct distance between start and goal pose
-  std::vector<double> path_length_; // length of path found from start to goal pose
-  std::vector<double> total_planning_time_; // total time between assigning a start and goal pose to the planner and output of final path
-
-  // characteristic values for statistics (diagnostics topic)
-  double max_salloc_size_, min_salloc_size_, max_traj_size_, min_traj_size_, max_plan_time_, min_plan_time_;
-  double sum_salloc_size_, sum_traj_size_, sum_plan_time_; // sum over all values (for calculation of mean)
-  double sqsum_salloc_size_, sqsum_traj_size_, sqsum_plan_time_; // sum of squared values (for calculation of root-mean-square deviation)
-
-  // characteristic values for statistics (statistics topic)
-  double max_startgoal_dist_, min_startgoal_dist_, max_path_length_, min_path_length_, max_plan_tottime_, min_plan_tottime_;
-  double sum_startgoal_dist_, sum_path_length_, sum_plan_tottime_; // sum over all values (for calculation of mean)
-  double sqsum_startgoal_dist_, sqsum_path_length_, sqsum_plan_tottime_; // sum of squared values (for calculation of root-mean-square deviation)
+  Metric start_goal_dist_; // direct distance between start and goal pose
+  Metric path_length_; // length of path found from start to goal pose
+  Metric total_planning_time_; // total time between assigning a start and goal pose to the planner and output of final path
 
 
   // Constructor
   NodeClass()
+    : planning_time_("planning_time", "Planning time (ompl) [s]", true),
+      trajectory_size_("trajectory_size", "Trajectory size/statenum (ompl)", false),
+      state_allocator_size_("state_allocator_size", "State allocator size (ompl)", false),
+      start_goal_dist_("start_goal_dist", "Direct distance from start to goal [m]", false),
+      path_length_("path_length", "Length of resulting path [m]", false),
+      total_planning_time_("total_planning_time", "Total time until output of plan [s]", true)
   {
-    // initialize vectors --> clear
-    planning_time_.clear();
-    trajectory_size_.clear();
-    state_allocator_size_.clear();
-    start_goal_dist_.clear();
-    path_length_.clear();
-    total_planning_time_.clear();
+    // get parameters
+    ros::NodeHandle private_nh("~");
+    private_nh.param("report_interval", report_interval_, 10.0);
+    private_nh.param("output_file", output_file_, std::string(""));
 
     // assign topics
     topic_sub_diagnostics_ = n_handle_.subscribe("/move_base_node/OMPLPlannerBase/diagnostics_ompl", 1, &NodeClass::topicCallbackDiagnostics, this);
@@ -106,38 +142,11 @@ public:
     // init counters
     num_plan_success_ = 0;
     num_plan_request_ = 0;
+    num_window_success_ = 0;
+    num_window_request_ = 0;
+    num_statistics_ = 0;
 
-    // init characteristic values for statistics (diagnostics_ompl)
-    max_salloc_size_ = 0.0;
-    min_salloc_size_ = 1000000;
-    max_traj_size_ = 0.0;
-    min_traj_size_ = 1000000;
-    max_plan_time_ = 0.0;
-    min_plan_time_ = 1000000.0;
-    // sum values
-    sum_salloc_size_ = 0.0;
-    sum_traj_size_ = 0.0;
-    sum_plan_time_ = 0.0;
-    // sum of squared values (for calculation of root-mean-square deviation)
-    sqsum_salloc_size_ = 0.0;
-    sqsum_traj_size_ = 0.0;
-    sqsum_plan_time_ = 0.0;
-
-    // init characteristic values for statistics (statistics_ompl)
-    max_startgoal_dist_ = 0.0;
-    min_startgoal_dist_ = 1000000.0;
-    max_path_length_ = 0.0;
-    min_path_length_ = 1000000.0;
-    max_plan_tottime_ = 0.0;
-    min_plan_tottime_ = 1000000.0;
-    // sum values
-    sum_startgoal_dist_ = 0.0;
-    sum_path_length_ = 0.0;
-    sum_plan_tottime_ = 0.0;
-    // sum of squared values (for calculation of root-mean-square deviation)
-    sqsum_startgoal_dist_ = 0.0;
-    sqsum_path_length_ = 0.0;
-    sqsum_plan_tottime_ = 0.0;
+    report_timer_ = n_handle_.createWallTimer(ros::WallDuration(std::max(report_interval_, 0.1)), &NodeClass::timerCallbackReport, this);
   }
 
   // Destructor
@@ -147,163 +156,166 @@ public:
   // topic Callbacks
 
   /**
-     * @brief  Callback for Diagnostics topic. This calculates some statistical measures for the diagnostic data. Every time a message is received the characteristic values are updated
+     * @brief  Callback for Diagnostics topic. Every time a message is received the statistics of the diagnostic data are updated
      * @param  Pointer to the received diagnostics message
      */
   void topicCallbackDiagnostics(const ompl_planner_base::OMPLPlannerDiagnostics::ConstPtr& msg)
   {
-    // instantiate temporary variables
-    double salloc_size, traj_size, plan_time;
-
     // increment counter for planning attempts
-    num_plan_request_ = num_plan_request_ + 1;
+    num_plan_request_++;
+    num_window_request_++;
 
     // check whether planning was successful (otherwise suppress input)
     if(msg->trajectory_size > 0)
     {
-      // successfull -> increment counter and get the values of interest from the msg
-      num_plan_success_ = num_plan_success_ + 1;
-      salloc_size = (double) msg->state_allocator_size;
-      traj_size = (double) msg->trajectory_size;
-      plan_time = (double) msg->planning_time;
-
-      // ... and write it to the vectors
-      state_allocator_size_.push_back(salloc_size);
-      trajectory_size_.push_back(traj_size);
-      planning_time_.push_back(plan_time);
-
-      // calculate characteristic values for statistics
-
-      // get min/max values
-      if(salloc_size > max_salloc_size_)
-        max_salloc_size_ = salloc_size;
-      if(salloc_size < min_salloc_size_)
-        min_salloc_size_ = salloc_size;
-
-      if(traj_size > max_traj_size_)
-        max_traj_size_ = traj_size;
-      if(traj_size < min_traj_size_)
-        min_traj_size_ = traj_size;
-
-      if(plan_time > max_plan_time_)
-        max_plan_time_ = plan_time;
-      if(plan_time < min_plan_time_)
-        min_plan_time_ = plan_time;
-
-      // sum up values values
-      sum_salloc_size_ = sum_salloc_size_ + salloc_size;
-      sum_traj_size_ = sum_traj_size_ + traj_size;
-      sum_plan_time_ = sum_plan_time_ + plan_time;
-
-      // sum of squared values (for calculation of root-mean-square deviation)
-      sqsum_salloc_size_ = sqsum_salloc_size_ + (salloc_size*salloc_size);
-      sqsum_traj_size_ = sqsum_traj_size_ + (traj_size*traj_size);
-      sqsum_plan_time_ = sqsum_plan_time_ + (plan_time*plan_time);
+      // successfull -> increment counter and add the values of interest
+      num_plan_success_++;
+      num_window_success_++;
+      state_allocator_size_.add((double) msg->state_allocator_size);
+      trajectory_size_.add((double) msg->trajectory_size);
+      planning_time_.add((double) msg->planning_time);
     }
+  }
+
+
+  /**
+     * @brief  Callback for Statistics topic. Every time a message is received the statistics of the statistic data are updated
+     * @param  Pointer to the received statistic message
+     */
+  void topicCallbackStatistics(const ompl_planner_base::OMPLPlannerBaseStats::ConstPtr& msg)
+  {
+    num_statistics_++;
+    start_goal_dist_.add(msg->start_goal_dist);
+    path_length_.add(msg->path_length);
+    total_planning_time_.add(msg->total_planning_time);
+  }
+
+
+  /**
+     * @brief  Logs the statistics of the last report window and of the whole run, then starts a new window
+     */
+  void timerCallbackReport(const ros::WallTimerEvent& event)
+  {
+    if(num_window_request_ == 0)
+      return;
+
+    // doublecheck whether data is consistent -> we should receive a statistics_ompl msg for every successful planning attempt
+    if(num_statistics_ != num_plan_success_)
+      ROS_WARN("Consistency check failed - Number of statistics (%d) and successful diagnostics msgs (%d) do not match", num_statistics_, num_plan_success_);
+
+    ROS_INFO("Last %.1f s: Plans requested: %d; Planning succeded: %d; Success-Rate: %f", report_interval_,
+             num_window_request_, num_window_success_, ((double) num_window_success_)/((double) num_window_request_));
+    logMetrics(true);
+
+    ROS_INFO("Total: Plans requested: %d; Planning succeded: %d; Success-Rate: %f",
+             num_plan_request_, num_plan_success_, ((double) num_plan_success_)/((double) num_plan_request_));
+    logMetrics(false);
+
+    // start new window
+    num_window_request_ = 0;
+    num_window_success_ = 0;
+    planning_time_.resetWindow();
+    trajectory_size_.resetWindow();
+    state_allocator_size_.resetWindow();
+    start_goal_dist_.resetWindow();
+    path_length_.resetWindow();
+    total_planning_time_.resetWindow();
+  }
+
+
+  void logMetrics(bool window)
+  {
+    logMetric(planning_time_, window);
+    logMetric(total_planning_time_, window);
+    logMetric(trajectory_size_, window);
+    logMetric(state_allocator_size_, window);
+    logMetric(path_length_, window);
+    logMetric(start_goal_dist_, window);
+  }
+
+
+  void logMetric(const Metric& metric, bool window)
+  {
+    const ompl_planner_base::RunningStatistics& stats = window ? metric.window : metric.total;
+    if(stats.getCount() == 0)
+      return;
 
-    // as soon as there are more than 2 plans made (huge number of samples;) --> print statistics
-    if(num_plan_success_ > 2)
+    if(metric.with_quantiles)
     {
-      // general
-      double success_rate = ((double) num_plan_success_)/((double) num_plan_request_);
-      ROS_INFO("Plans requested: %d; Planning succeded: %d; Success-Rate: %f", num_plan_request_, num_plan_success_, success_rate);
-
-      // statistics on planning time
-      double mean_plan_time = sum_plan_time_/num_plan_success_;
-      double sqmean_plan_time = sqsum_plan_time_/num_plan_success_;
-      double rmsdev_plan_time = sqrt(sqmean_plan_time - mean_plan_time*mean_plan_time);
-      ROS_INFO("Planning time (ompl) [s]: min: %f, max: %f, mean: %f, rms-dev: %f", min_plan_time_, max_plan_time_, mean_plan_time, rmsdev_plan_time);
-
-      // statistics on trajectory size
-      double mean_traj_size = sum_traj_size_/num_plan_success_;
-      double sqmean_traj_size = sqsum_traj_size_/num_plan_success_;
-      double rmsdev_traj_size = sqrt(sqmean_traj_size - mean_traj_size*mean_traj_size);
-      ROS_INFO("Trajectory size/statenum (ompl): min: %f, max: %f, mean: %f, rms-dev: %f", min_traj_size_, max_traj_size_, mean_traj_size, rmsdev_traj_size);
-
-      // statistics on state allocator size
-      double mean_salloc_size = sum_salloc_size_/num_plan_success_;
-      double sqmean_salloc_size = sqsum_salloc_size_/num_plan_success_;
-      double rmsdev_salloc_size = sqrt(sqmean_salloc_size - mean_salloc_size*mean_salloc_size);
-      ROS_INFO("State allocator size (ompl): min: %f, max: %f, mean: %f, rms-dev: %f", min_salloc_size_, max_salloc_size_, mean_salloc_size, rmsdev_salloc_size);
+      const ompl_planner_base::QuantileHistogram& histogram = window ? metric.window_histogram : metric.total_histogram;
+      ROS_INFO("%s: min: %f, max: %f, mean: %f, std-dev: %f, p50: %f, p90: %f, p99: %f, p99.9: %f", metric.description.c_str(),
+               stats.getMin(), stats.getMax(), stats.getMean(), stats.getStdDev(),
+               histogram.getQuantile(0.5), histogram.getQuantile(0.9), histogram.getQuantile(0.99), histogram.getQuantile(0.999));
+    }
+    else
+    {
+      ROS_INFO("%s: min: %f, max: %f, mean: %f, std-dev: %f", metric.description.c_str(),
+               stats.getMin(), stats.getMax(), stats.getMean(), stats.getStdDev());
     }
   }
 
 
-
   /**
-     * @brief  Callback for Statistics topic. This calculates some statistical measures for the statistic data. Every time a message is received the characteristic values are updated
-     * @param  Pointer to the received statistic message
+     * @brief  Writes the statistics of the whole run to output_file (JSON if its name ends with .json, CSV otherwise)
      */
-  void topicCallbackStatistics(const ompl_planner_base::OMPLPlannerBaseStats::ConstPtr& msg)
+  void writeSummary()
   {
-    // instantiate temporary variables
-    double startgoal_dist, path_length, plan_tottime;
-
-    // get values from msg and write it to the vectors
-    startgoal_dist = msg->start_goal_dist;
-    path_length = msg->path_length;
-    plan_tottime = msg->total_planning_time;
-
-    // ... and write it to the vectors
-    start_goal_dist_.push_back(startgoal_dist);
-    path_length_.push_back(path_length);
-    total_planning_time_.push_back(plan_tottime);
-
-    // calculate characteristic values for statistics
-
-    // get min/max values
-    if(startgoal_dist > max_startgoal_dist_)
-      max_startgoal_dist_ = startgoal_dist;
-    if(startgoal_dist < min_startgoal_dist_)
-      min_startgoal_dist_ = startgoal_dist;
-
-    if(path_length > max_path_length_)
-      max_path_length_ = path_length;
-    if(path_length < min_path_length_)
-      min_path_length_ = path_length;
-
-    if(plan_tottime > max_plan_tottime_)
-      max_plan_tottime_ = plan_tottime;
-    if(plan_tottime < min_plan_tottime_)
-      min_plan_tottime_ = plan_tottime;
-
-    // sum up values
-    sum_startgoal_dist_ = sum_startgoal_dist_ + startgoal_dist;
-    sum_path_length_ = sum_path_length_ + path_length;
-    sum_plan_tottime_ = sum_plan_tottime_ + plan_tottime;
-
-    // sum of squared values (for calculation of root-mean-square deviation)
-    sqsum_startgoal_dist_ = sqsum_startgoal_dist_ + (startgoal_dist*startgoal_dist);
-    sqsum_path_length_ = sqsum_path_length_ + (path_length*path_length);
-    sqsum_plan_tottime_ = sqsum_plan_tottime_ + (plan_tottime*plan_tottime);
-
-    // as soon as there are more than 2 plans made (huge number of samples;) --> print statistics
-    if(num_plan_success_ > 2)
+    if(output_file_.empty())
+      return;
+
+    std::ofstream file(output_file_.c_str());
+    if(!file)
     {
-      // doublecheck whether data is consistent -> we should receive a statistics_ompl msg for every successful planning attempt
-      if(!num_plan_success_ == start_goal_dist_.size())
-        ROS_WARN("Consistency check failed - Number of statistics and diagnostics msgs seem not to match");
-
-      // anyway calculate the characteristic values and log them out
-
-      // statistics on path length
-      double mean_path_length = sum_path_length_/num_plan_success_;
-      double sqmean_path_length = sqsum_path_length_/num_plan_success_;
-      double rmsdev_path_length = sqrt(sqmean_path_length - mean_path_length*mean_path_length);
-      ROS_INFO("Length of resulting path [m]: min: %f, max: %f, mean: %f, rms-dev: %f", min_path_length_, max_path_length_, mean_path_length, rmsdev_path_length);
-
-      // statistics on distance between start and goal -> to compare with path length
-      double mean_startgoal_dist = sum_startgoal_dist_/num_plan_success_;
-      double sqmean_startgoal_dist = sqsum_startgoal_dist_/num_plan_success_;
-      double rmsdev_startgoal_dist = sqrt(sqmean_startgoal_dist - mean_startgoal_dist*mean_startgoal_dist);
-      ROS_INFO("Direct distance from start to goal [m]: min: %f, max: %f, mean: %f, rms-dev: %f", min_startgoal_dist_, max_startgoal_dist_, mean_startgoal_dist, rmsdev_startgoal_dist);
-
-      // statistics on total time for planning
-      double mean_plan_tottime = sum_plan_tottime_/num_plan_success_;
-      double sqmean_plan_tottime = sqsum_plan_tottime_/num_plan_success_;
-      double rmsdev_plan_tottime = sqrt(sqmean_plan_tottime - mean_plan_tottime*mean_plan_tottime);
-      ROS_INFO("Total time until output of plan [s]: min: %f, max: %f, mean: %f, rms-dev: %f", min_plan_tottime_, max_plan_tottime_, mean_plan_tottime, rmsdev_plan_tottime);
+      ROS_ERROR("Could not open %s to write the summary", output_file_.c_str());
+      return;
     }
+
+    const Metric* metrics[] = {&planning_time_, &total_planning_time_, &trajectory_size_, &state_allocator_size_, &path_length_, &start_goal_dist_};
+    const unsigned int num_metrics = sizeof(metrics) / sizeof(metrics[0]);
+    const bool json = (output_file_.size() >= 5) && (output_file_.compare(output_file_.size() - 5, 5, ".json") == 0);
+
+    file.precision(9);
+    if(json)
+    {
+      file << "{\"plans_requested\": " << num_plan_request_ << ", \"plans_succeeded\": " << num_plan_success_ << ", \"metrics\": {";
+      for(unsigned int i = 0; i < num_metrics; i++)
+      {
+        const Metric& metric = *metrics[i];
+        file << (i > 0 ? ", " : "") << "\n  \"" << metric.key << "\": {\"count\": " << metric.total.getCount()
+             << ", \"min\": " << metric.total.getMin() << ", \"max\": " << metric.total.getMax()
+             << ", \"mean\": " << metric.total.getMean() << ", \"std_dev\": " << metric.total.getStdDev();
+        if(metric.with_quantiles)
+        {
+          file << ", \"p50\": " << metric.total_histogram.getQuantile(0.5) << ", \"p90\": " << metric.total_histogram.getQuantile(0.9)
+               << ", \"p99\": " << metric.total_histogram.getQuantile(0.99) << ", \"p99.9\": " << metric.total_histogram.getQuantile(0.999);
+        }
+        file << "}";
+      }
+      file << "\n}}\n";
+    }
+    else
+    {
+      file << "# plans_requested: " << num_plan_request_ << ", plans_succeeded: " << num_plan_success_ << "\n";
+      file << "metric,count,min,max,mean,std_dev,p50,p90,p99,p99.9\n";
+      for(unsigned int i = 0; i < num_metrics; i++)
+      {
+        const Metric& metric = *metrics[i];
+        file << metric.key << "," << metric.total.getCount() << "," << metric.total.getMin() << "," << metric.total.getMax()
+             << "," << metric.total.getMean() << "," << metric.total.getStdDev();
+        if(metric.with_quantiles)
+        {
+          file << "," << metric.total_histogram.getQuantile(0.5) << "," << metric.total_histogram.getQuantile(0.9)
+               << "," << metric.total_histogram.getQuantile(0.99) << "," << metric.total_histogram.getQuantile(0.999);
+        }
+        else
+        {
+          file << ",,,,";
+        }
+        file << "\n";
+      }
+    }
+
+    ROS_INFO("Wrote summary of %d planning requests to %s", num_plan_request_, output_file_.c_str());
   }
 };
 
@@ -333,21 +345,8 @@ int main(int argc, char** argv)
     loop_rate.sleep();
   }
 
+  // store statistics of the whole run
+  nodeClass.writeSummary();
+
   return 0;
 }
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
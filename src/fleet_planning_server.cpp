@@ -0,0 +1,308 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#include <ros/ros.h>
+#include <tf/transform_listener.h>
+#include <costmap_2d/costmap_2d_ros.h>
+
+// ros sandbox classes
+#include <ompl_planner_base/ompl_planner_base.h>
+#include <ompl_planner_base/costmap_snapshot.h>
+#include <ompl_planner_base/FleetPlan.h>
+
+// boost classes
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+// std c++ classes
+#include <algorithm>
+#include <deque>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+/**
+ * @class FleetPlanningServer
+ * @brief Central planning server for a fleet of robots sharing one map. Planning requests are queued and served
+ *  concurrently by a pool of planners, each with its own state space, simple setup and caches.
+ *
+ *  Requests are pushed to the queues of the workers round-robin. A worker takes the oldest request of its own queue
+ *  and steals the newest request of another queue if its own is empty. All workers plan on the same immutable
+ *  snapshot of the costmap, which is replaced by a fresh copy once it is older than max_snapshot_age.
+ *  The planners share the footprint of the costmap and are configured from the parameters in ~planner.
+ */
+class FleetPlanningServer
+{
+public:
+  FleetPlanningServer(tf::TransformListener& tf)
+    : next_worker_(0), num_pending_(0), shutdown_(false)
+  {
+    ros::NodeHandle private_nh("~");
+    int num_workers;
+    private_nh.param("num_workers", num_workers, (int) std::max(boost::thread::hardware_concurrency(), 1u));
+    private_nh.param("max_snapshot_age", max_snapshot_age_, 0.5);
+    num_workers = std::max(num_workers, 1);
+
+    costmap_ros_ = new costmap_2d::Costmap2DROS("global_costmap", tf);
+
+    // every planner reads its parameters from its own namespace -> all of them start with the ones given for ~planner
+    XmlRpc::XmlRpcValue planner_params;
+    const bool has_planner_params = private_nh.getParam("planner", planner_params);
+    for(int i = 0; i < num_workers; i++)
+    {
+      std::ostringstream name;
+      name << "worker_" << i;
+      if(has_planner_params)
+        private_nh.setParam(name.str(), planner_params);
+
+      boost::shared_ptr<Worker> worker(new Worker());
+      worker->planner = boost::shared_ptr<ompl_planner_base::OMPLPlannerBase>(
+        new ompl_planner_base::OMPLPlannerBase(name.str(), costmap_ros_));
+      workers_.push_back(worker);
+    }
+
+    for(unsigned int i = 0; i < workers_.size(); i++)
+    {
+      threads_.create_thread(boost::bind(&FleetPlanningServer::runWorker, this, i));
+    }
+
+    plan_srv_ = private_nh.advertiseService("plan", &FleetPlanningServer::planService, this);
+    ROS_INFO("Fleet planning server started with %d workers", (int) workers_.size());
+  }
+
+  ~FleetPlanningServer()
+  {
+    {
+      boost::mutex::scoped_lock lock(pool_mutex_);
+      shutdown_ = true;
+      work_available_.notify_all();
+    }
+    threads_.join_all();
+
+    // planners use the costmap until they are destroyed
+    workers_.clear();
+    delete costmap_ros_;
+  }
+
+private:
+  /**
+     * @brief Request waiting in a queue, the service call blocks until it is done
+     */
+  struct Job
+  {
+    const ompl_planner_base::FleetPlan::Request* request;
+    ompl_planner_base::FleetPlan::Response* response;
+    ros::WallTime enqueue_time;
+    bool done;
+  };
+
+  /**
+     * @brief Planner with the queue of the requests assigned to it
+     */
+  struct Worker
+  {
+    boost::shared_ptr<ompl_planner_base::OMPLPlannerBase> planner;
+    boost::mutex mutex;
+    std::deque<Job*> queue;
+  };
+
+  /**
+     * @brief Service callback, queues the request and waits until a worker has served it
+     */
+  bool planService(ompl_planner_base::FleetPlan::Request& req, ompl_planner_base::FleetPlan::Response& res)
+  {
+    Job job;
+    job.request = &req;
+    job.response = &res;
+    job.enqueue_time = ros::WallTime::now();
+    job.done = false;
+
+    boost::mutex::scoped_lock lock(pool_mutex_);
+    if(shutdown_)
+      return false;
+
+    Worker& worker = *workers_[next_worker_];
+    next_worker_ = (next_worker_ + 1) % workers_.size();
+    {
+      boost::mutex::scoped_lock queue_lock(worker.mutex);
+      worker.queue.push_back(&job);
+    }
+    num_pending_++;
+    work_available_.notify_one();
+
+    while(!job.done)
+    {
+      job_done_.wait(lock);
+    }
+    return true;
+  }
+
+  /**
+     * @brief Takes the oldest request of the own queue, or steals the newest one of another queue
+     * @return NULL if all queues are empty
+     */
+  Job* takeJob(unsigned int index)
+  {
+    for(unsigned int i = 0; i < workers_.size(); i++)
+    {
+      Worker& worker = *workers_[(index + i) % workers_.size()];
+      boost::mutex::scoped_lock queue_lock(worker.mutex);
+      if(worker.queue.empty())
+        continue;
+
+      Job* job;
+      if(i == 0)
+      {
+        job = worker.queue.front();
+        worker.queue.pop_front();
+      }
+      else
+      {
+        job = worker.queue.back();
+        worker.queue.pop_back();
+      }
+      return job;
+    }
+    return NULL;
+  }
+
+  /**
+     * @brief Returns the snapshot to plan on, replaced by a fresh copy of the costmap if it is too old
+     *        (snapshots still used by other workers stay untouched until the last one drops them)
+     */
+  ompl_planner_base::CostmapSnapshotPtr getSnapshot()
+  {
+    boost::mutex::scoped_lock lock(snapshot_mutex_);
+    const ros::WallTime now = ros::WallTime::now();
+    if(!snapshot_ || ((now - snapshot_time_).toSec() > max_snapshot_age_))
+    {
+      ompl_planner_base::CostmapSnapshotPtr snapshot(new ompl_planner_base::CostmapSnapshot());
+      snapshot->copy(*costmap_ros_->getCostmap());
+      snapshot_ = snapshot;
+      snapshot_time_ = now;
+    }
+    return snapshot_;
+  }
+
+  /**
+     * @brief Thread function of a worker, serves requests until the server shuts down
+     */
+  void runWorker(unsigned int index)
+  {
+    Worker& worker = *workers_[index];
+    while(true)
+    {
+      Job* job = takeJob(index);
+      if(!job)
+      {
+        boost::mutex::scoped_lock lock(pool_mutex_);
+        while( (num_pending_ == 0) && !shutdown_ )
+        {
+          work_available_.wait(lock);
+        }
+        if(shutdown_)
+          return;
+        continue;
+      }
+
+      {
+        boost::mutex::scoped_lock lock(pool_mutex_);
+        num_pending_--;
+      }
+
+      const ros::WallTime solve_start_time = ros::WallTime::now();
+      ompl_planner_base::FleetPlan::Response& res = *job->response;
+      res.queue_wait_time = (solve_start_time - job->enqueue_time).toSec();
+      worker.planner->setCostmapSnapshot(getSnapshot());
+      res.success = worker.planner->makePlan(job->request->start, job->request->goal, res.path.poses);
+      res.solve_time = (ros::WallTime::now() - solve_start_time).toSec();
+      res.worker = index;
+      res.path.header.frame_id = costmap_ros_->getGlobalFrameID();
+      res.path.header.stamp = ros::Time::now();
+      ROS_DEBUG("Worker %d served request of %s: waited %f s, solved in %f s", (int) index, job->request->robot_id.c_str(),
+                res.queue_wait_time, res.solve_time);
+
+      boost::mutex::scoped_lock lock(pool_mutex_);
+      job->done = true;
+      job_done_.notify_all();
+    }
+  }
+
+  costmap_2d::Costmap2DROS* costmap_ros_;
+  std::vector<boost::shared_ptr<Worker> > workers_;
+  boost::thread_group threads_;
+
+  // pool state, guarded by pool_mutex_
+  boost::mutex pool_mutex_;
+  boost::condition_variable work_available_, job_done_;
+  unsigned int next_worker_;
+  unsigned int num_pending_; // number of queued requests not taken by a worker yet
+  bool shutdown_;
+
+  // snapshot shared by all workers
+  boost::mutex snapshot_mutex_;
+  ompl_planner_base::CostmapSnapshotPtr snapshot_;
+  ros::WallTime snapshot_time_;
+  double max_snapshot_age_; // [s]
+
+  ros::ServiceServer plan_srv_;
+};
+
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "fleet_planning_server");
+  ros::NodeHandle private_nh("~");
+
+  // every service call blocks a spinner thread until its request is served -> bounds the number of requests in flight
+  int max_concurrent_requests;
+  private_nh.param("max_concurrent_requests", max_concurrent_requests, 32);
+
+  tf::TransformListener tf(ros::Duration(10));
+  FleetPlanningServer server(tf);
+
+  ros::AsyncSpinner spinner(std::max(max_concurrent_requests, 1) + 1);
+  spinner.start();
+  ros::waitForShutdown();
+  spinner.stop();
+
+  return 0;
+}
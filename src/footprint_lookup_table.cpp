@@ -0,0 +1,324 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#include <ompl_planner_base/footprint_lookup_table.h>
+#include <costmap_2d/cost_values.h>
+#include <angles/angles.h>
+
+// std c++ classes
+#include <math.h>
+#include <algorithm>
+#include <utility>
+
+
+namespace ompl_planner_base {
+
+  // z-component of the cross product of (a - o) and (b - o), positive for a counter-clockwise turn
+  static inline double cross(const std::pair<double, double>& o, const std::pair<double, double>& a, const std::pair<double, double>& b)
+  {
+    return (a.first - o.first) * (b.second - o.second) - (a.second - o.second) * (b.first - o.first);
+  }
+
+
+  // monotone chain, hull is counter-clockwise without repeating the first point
+  static void computeConvexHull(std::vector<std::pair<double, double> >& points, std::vector<std::pair<double, double> >& hull)
+  {
+    std::sort(points.begin(), points.end());
+    const int num_points = (int) points.size();
+    hull.resize(2 * num_points);
+    int k = 0;
+
+    // lower hull
+    for(int i = 0; i < num_points; i++)
+    {
+      while( (k >= 2) && (cross(hull[k-2], hull[k-1], points[i]) <= 0.0) )
+        k--;
+      hull[k++] = points[i];
+    }
+
+    // upper hull
+    for(int i = num_points - 2, lower_size = k + 1; i >= 0; i--)
+    {
+      while( (k >= lower_size) && (cross(hull[k-2], hull[k-1], points[i]) <= 0.0) )
+        k--;
+      hull[k++] = points[i];
+    }
+
+    hull.resize(std::max(k - 1, 0));
+  }
+
+
+  // marks the cells whose centers (integer coordinates) lie inside the hull or on its boundary, row by row
+  static void markHullCells(const std::vector<std::pair<double, double> >& hull, int mask_min_x, int mask_min_y,
+                            int mask_max_x, int mask_max_y, std::vector<unsigned char>& mask)
+  {
+    if(hull.empty())
+      return;
+
+    const double tolerance = 1e-9;
+    const int mask_size_x = mask_max_x - mask_min_x + 1;
+    double min_y = hull[0].second, max_y = hull[0].second;
+    for(unsigned int i = 1; i < hull.size(); i++)
+    {
+      min_y = std::min(min_y, hull[i].second);
+      max_y = std::max(max_y, hull[i].second);
+    }
+
+    for(int y = std::max((int) ceil(min_y - tolerance), mask_min_y); y <= std::min((int) floor(max_y + tolerance), mask_max_y); y++)
+    {
+      // extension of the hull along the row -> intersect all edges with it
+      double row_min_x = 0.0, row_max_x = 0.0;
+      bool row_covered = false;
+      for(unsigned int i = 0; i < hull.size(); i++)
+      {
+        const std::pair<double, double>& a = hull[i];
+        const std::pair<double, double>& b = hull[(i + 1) % hull.size()];
+        if( (y < std::min(a.second, b.second) - tolerance) || (y > std::max(a.second, b.second) + tolerance) )
+          continue;
+
+        double x0 = a.first, x1 = b.first;
+        if(fabs(b.second - a.second) > tolerance)
+        {
+          x0 = a.first + (y - a.second) * (b.first - a.first) / (b.second - a.second);
+          x1 = x0;
+        }
+        row_min_x = row_covered ? std::min(row_min_x, std::min(x0, x1)) : std::min(x0, x1);
+        row_max_x = row_covered ? std::max(row_max_x, std::max(x0, x1)) : std::max(x0, x1);
+        row_covered = true;
+      }
+      if(!row_covered)
+        continue;
+
+      const int first_x = std::max((int) ceil(row_min_x - tolerance), mask_min_x);
+      const int last_x = std::min((int) floor(row_max_x + tolerance), mask_max_x);
+      for(int x = first_x; x <= last_x; x++)
+      {
+        mask[(size_t) (y - mask_min_y) * mask_size_x + (x - mask_min_x)] = 1;
+      }
+    }
+  }
+
+
+  FootprintLookupTable::FootprintLookupTable()
+    : initialized_(false), resolution_(0.0), num_yaw_bins_(0){}
+
+
+  bool FootprintLookupTable::initialize(const std::vector<geometry_msgs::Point>& footprint,
+                                        double resolution, unsigned int num_yaw_bins)
+  {
+    initialized_ = false;
+    offsets_x_.clear();
+    offsets_y_.clear();
+    bin_begin_.clear();
+    min_dx_.clear();
+    max_dx_.clear();
+    min_dy_.clear();
+    max_dy_.clear();
+
+    if( (footprint.size() < 3) || (resolution <= 0.0) || (num_yaw_bins == 0) )
+      return false;
+
+    footprint_ = footprint;
+    resolution_ = resolution;
+    num_yaw_bins_ = num_yaw_bins;
+
+    bin_begin_.reserve(num_yaw_bins_ + 1);
+    min_dx_.resize(num_yaw_bins_);
+    max_dx_.resize(num_yaw_bins_);
+    min_dy_.resize(num_yaw_bins_);
+    max_dy_.resize(num_yaw_bins_);
+
+    std::vector<int> corner_min_x(footprint_.size()), corner_max_x(footprint_.size());
+    std::vector<int> corner_min_y(footprint_.size()), corner_max_y(footprint_.size());
+    std::vector<unsigned char> mask;
+    std::vector<std::pair<double, double> > points, hull;
+
+    const double bin_width = (2.0 * M_PI) / num_yaw_bins_;
+    for(unsigned int bin = 0; bin < num_yaw_bins_; bin++)
+    {
+      // a bin holds all orientations rounded to it (see getYawBin), the robot center may lie anywhere in its cell
+      const double yaw = bin * bin_width;
+      for(unsigned int i = 0; i < footprint_.size(); i++)
+      {
+        getCornerCellRange(footprint_[i], yaw - 0.5 * bin_width, yaw + 0.5 * bin_width,
+                           corner_min_x[i], corner_max_x[i], corner_min_y[i], corner_max_y[i]);
+      }
+
+      int mask_min_x = *std::min_element(corner_min_x.begin(), corner_min_x.end());
+      int mask_max_x = *std::max_element(corner_max_x.begin(), corner_max_x.end());
+      int mask_min_y = *std::min_element(corner_min_y.begin(), corner_min_y.end());
+      int mask_max_y = *std::max_element(corner_max_y.begin(), corner_max_y.end());
+      const int mask_size_x = mask_max_x - mask_min_x + 1;
+      mask.assign((size_t) mask_size_x * (mask_max_y - mask_min_y + 1), 0);
+
+      // the costmap model lays down the outline between the cells of the corners -> union of the outlines between
+      // all cells each corner can fall into covers the outline of every pose of the bin. Each cell of such a line
+      // lies within half a cell of the straight segment, so the union of the lines of an edge is covered by the
+      // convex hull of the cell ranges of both corners grown by half a cell
+      for(unsigned int i = 0; i < footprint_.size(); i++)
+      {
+        const unsigned int j = (i + 1) % footprint_.size();
+        points.clear();
+        for(unsigned int k = 0; k < 2; k++)
+        {
+          const unsigned int c = (k == 0) ? i : j;
+          points.push_back(std::make_pair(corner_min_x[c] - 0.5, corner_min_y[c] - 0.5));
+          points.push_back(std::make_pair(corner_max_x[c] + 0.5, corner_min_y[c] - 0.5));
+          points.push_back(std::make_pair(corner_min_x[c] - 0.5, corner_max_y[c] + 0.5));
+          points.push_back(std::make_pair(corner_max_x[c] + 0.5, corner_max_y[c] + 0.5));
+        }
+        computeConvexHull(points, hull);
+        markHullCells(hull, mask_min_x, mask_min_y, mask_max_x, mask_max_y, mask);
+      }
+
+      bin_begin_.push_back(offsets_x_.size());
+      min_dx_[bin] = mask_max_x;
+      max_dx_[bin] = mask_min_x;
+      min_dy_[bin] = mask_max_y;
+      max_dy_[bin] = mask_min_y;
+      for(size_t k = 0; k < mask.size(); k++)
+      {
+        if(!mask[k])
+          continue;
+        const int dx = mask_min_x + (int) (k % mask_size_x);
+        const int dy = mask_min_y + (int) (k / mask_size_x);
+        offsets_x_.push_back(dx);
+        offsets_y_.push_back(dy);
+        min_dx_[bin] = std::min(min_dx_[bin], dx);
+        max_dx_[bin] = std::max(max_dx_[bin], dx);
+        min_dy_[bin] = std::min(min_dy_[bin], dy);
+        max_dy_[bin] = std::max(max_dy_[bin], dy);
+      }
+    }
+    bin_begin_.push_back(offsets_x_.size());
+
+    initialized_ = true;
+    return true;
+  }
+
+
+  bool FootprintLookupTable::matches(const std::vector<geometry_msgs::Point>& footprint,
+                                     double resolution, unsigned int num_yaw_bins) const
+  {
+    if( !initialized_ || (resolution != resolution_) || (num_yaw_bins != num_yaw_bins_) )
+      return false;
+
+    if(footprint.size() != footprint_.size())
+      return false;
+
+    for(unsigned int i = 0; i < footprint.size(); i++)
+    {
+      if( (footprint[i].x != footprint_[i].x) || (footprint[i].y != footprint_[i].y) )
+        return false;
+    }
+    return true;
+  }
+
+
+  unsigned int FootprintLookupTable::getYawBin(double theta) const
+  {
+    // map angle to [0, 2pi) and round to the closest bin
+    double yaw = angles::normalize_angle_positive(theta);
+    unsigned int bin = (unsigned int) floor(yaw * num_yaw_bins_ / (2.0 * M_PI) + 0.5);
+    return (bin >= num_yaw_bins_) ? 0 : bin;
+  }
+
+
+  void FootprintLookupTable::getCornerCellRange(const geometry_msgs::Point& corner, double yaw_min, double yaw_max,
+                                                int& min_x, int& max_x, int& min_y, int& max_y) const
+  {
+    // extremes of the rotated corner are at the ends of the interval and where its arc crosses an axis
+    const double radius = sqrt(corner.x * corner.x + corner.y * corner.y);
+    const double theta_min = atan2(corner.y, corner.x) + yaw_min;
+    const double theta_max = theta_min + (yaw_max - yaw_min);
+    double lo_x = std::min(cos(theta_min), cos(theta_max)), hi_x = std::max(cos(theta_min), cos(theta_max));
+    double lo_y = std::min(sin(theta_min), sin(theta_max)), hi_y = std::max(sin(theta_min), sin(theta_max));
+    for(int k = (int) ceil(theta_min / M_PI_2); k * M_PI_2 <= theta_max; k++)
+    {
+      switch(((k % 4) + 4) % 4)
+      {
+        case 0: hi_x = 1.0; break;
+        case 1: hi_y = 1.0; break;
+        case 2: lo_x = -1.0; break;
+        case 3: lo_y = -1.0; break;
+      }
+    }
+
+    // corner lies at (offset of the center inside its cell in [0, 1)) + (rotated corner in cells), the small
+    // tolerance covers the rounding of the transform done by the costmap model
+    const double tolerance = 1e-6;
+    min_x = (int) floor(radius * lo_x / resolution_ - tolerance);
+    max_x = (int) floor(radius * hi_x / resolution_ + tolerance) + 1;
+    min_y = (int) floor(radius * lo_y / resolution_ - tolerance);
+    max_y = (int) floor(radius * hi_y / resolution_ + tolerance) + 1;
+  }
+
+
+  double FootprintLookupTable::footprintCost(const CostmapView& costmap,
+                                             double x, double y, double theta) const
+  {
+    if(!initialized_)
+      return -1.0;
+
+    unsigned int cell_x, cell_y;
+    if(!costmap.worldToMap(x, y, cell_x, cell_y))
+      return -1.0;
+
+    const unsigned int bin = getYawBin(theta);
+    const int size_x = (int) costmap.getSizeInCellsX();
+    const int size_y = (int) costmap.getSizeInCellsY();
+
+    // footprint (partly) off the map -> treat as collision, as the costmap model does
+    if( ((int) cell_x + min_dx_[bin] < 0) || ((int) cell_x + max_dx_[bin] >= size_x) ||
+        ((int) cell_y + min_dy_[bin] < 0) || ((int) cell_y + max_dy_[bin] >= size_y) )
+      return -1.0;
+
+    const unsigned char* center = costmap.getCharMap() + costmap.getIndex(cell_x, cell_y);
+    unsigned char footprint_cost = 0;
+
+    for(unsigned int k = bin_begin_[bin]; k < bin_begin_[bin + 1]; k++)
+    {
+      const unsigned char cost = center[offsets_y_[k] * size_x + offsets_x_[k]];
+      if( (cost == costmap_2d::LETHAL_OBSTACLE) || (cost == costmap_2d::NO_INFORMATION) )
+        return -1.0;
+      footprint_cost = std::max(footprint_cost, cost);
+    }
+
+    return footprint_cost;
+  }
+
+}
@@ -0,0 +1,601 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#include <ros/ros.h>
+#include <costmap_2d/cost_values.h>
+#include <nav_msgs/Path.h>
+
+// ros sandbox classes
+#include <ompl_planner_base/ompl_planner_base.h>
+#include <ompl_planner_base/costmap_view.h>
+
+// ompl planner specific classes
+#include <ompl/base/SpaceInformation.h>
+#include <ompl/base/spaces/SE2StateSpace.h>
+#include <ompl/geometric/PathGeometric.h>
+#include <ompl/util/RandomNumbers.h>
+
+// std c++ classes
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+// every allocation of the process is counted -> allocations per operation of the benchmarks (which run on one thread)
+static unsigned long g_num_allocations = 0;
+
+// replacement functions are declared without a dynamic exception specification (removed in C++17)
+#if __cplusplus >= 201103L
+#define BENCHMARK_NOEXCEPT noexcept
+#else
+#define BENCHMARK_NOEXCEPT throw()
+#endif
+
+void* operator new(std::size_t size)
+{
+  g_num_allocations++;
+  void* memory = malloc(size > 0 ? size : 1);
+  if(memory == NULL)
+    throw std::bad_alloc();
+  return memory;
+}
+
+void* operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void* memory) BENCHMARK_NOEXCEPT
+{
+  free(memory);
+}
+
+void operator delete[](void* memory) BENCHMARK_NOEXCEPT
+{
+  free(memory);
+}
+
+#if __cplusplus >= 201103L
+// used instead of the unsized versions from C++14 on
+void operator delete(void* memory, std::size_t) noexcept
+{
+  free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+  free(memory);
+}
+#endif
+
+// results of the benchmarks end up here, so the compiler can not drop the measured calls
+static volatile double g_sink = 0.0;
+
+// number of precomputed inputs the benchmarks cycle through (power of two)
+static const unsigned int NUM_INPUTS = 1024;
+
+
+namespace ompl_planner_base {
+
+/**
+ * @brief Sets up the members of a planner the validity checks and path conversions depend on, and calls them
+ *        (a planner constructed without initialize() does not need a costmap_2d::Costmap2DROS or a ros master)
+ */
+class PlannerBenchmarkAccess
+{
+public:
+  enum CheckMode { OUTLINE, LOOKUP_TABLE, TIERED };
+
+  static void setupChecks(OMPLPlannerBase& planner, const CostmapView& costmap, const std::vector<geometry_msgs::Point>& footprint,
+                          CheckMode mode, unsigned int fast_accept_distance, unsigned char circumscribed_cost)
+  {
+    planner.costmap_view_ = costmap;
+    planner.footprint_spec_ = footprint;
+    planner.max_footprint_cost_ = 256;
+    planner.use_footprint_lookup_table_ = (mode != OUTLINE);
+    planner.footprint_lookup_yaw_bins_ = 72;
+    planner.use_tiered_validity_check_ = (mode == TIERED);
+    planner.circumscribed_cost_ = circumscribed_cost;
+    planner.fast_accept_distance_ = fast_accept_distance;
+    planner.updateUnknownBlocks(false);
+    planner.use_validity_cache_ = false;
+    planner.profile_collision_checks_ = false;
+    if(planner.use_footprint_lookup_table_)
+      planner.footprint_lookup_table_.initialize(footprint, costmap.getResolution(), planner.footprint_lookup_yaw_bins_);
+  }
+
+  static unsigned int getFastAcceptDistance(double circumscribed_radius, double resolution)
+  {
+    return OMPLPlannerBase::getFastAcceptDistance(circumscribed_radius, resolution);
+  }
+
+  static void setupInterpolation(OMPLPlannerBase& planner, double max_dist_between_pathframes)
+  {
+    planner.interpolate_path_ = true;
+    planner.max_dist_between_pathframes_ = max_dist_between_pathframes;
+  }
+
+  static double footprintCost(const OMPLPlannerBase& planner, const geometry_msgs::Pose2D& pose)
+  {
+    return planner.footprintCost(pose);
+  }
+
+  static bool isStateValid2DGrid(const OMPLPlannerBase& planner, const ompl::base::State* state)
+  {
+    return planner.isStateValid2DGrid(state);
+  }
+
+  static bool convertPath(OMPLPlannerBase& planner, const ompl::geometric::PathGeometric& path, std::vector<geometry_msgs::PoseStamped>& plan)
+  {
+    return planner.convertPath(path, "map", plan);
+  }
+
+  static void publishPlan(OMPLPlannerBase& planner, const std::vector<geometry_msgs::PoseStamped>& plan)
+  {
+    planner.publishPlan(plan);
+  }
+};
+
+}
+
+using ompl_planner_base::PlannerBenchmarkAccess;
+
+
+/**
+ * @brief Measured time and allocations of one benchmark
+ */
+struct BenchmarkResult
+{
+  std::string name;
+  unsigned long iterations;
+  double ns_per_op, allocations_per_op;
+};
+
+
+/**
+ * @brief Runs a benchmark (functor taking the number of iterations) with as many iterations as fit into min_time
+ */
+template <typename Benchmark>
+BenchmarkResult runBenchmark(const std::string& name, Benchmark& benchmark, double min_time)
+{
+  // first call may allocate scratch buffers kept for the following ones
+  benchmark(1);
+
+  BenchmarkResult result;
+  result.name = name;
+  unsigned long iterations = 1;
+  while(true)
+  {
+    const unsigned long allocations = g_num_allocations;
+    const ros::WallTime start_time = ros::WallTime::now();
+    benchmark(iterations);
+    const double elapsed = (ros::WallTime::now() - start_time).toSec();
+    const unsigned long num_allocations = g_num_allocations - allocations;
+
+    if( (elapsed >= min_time) || (iterations >= (1ul << 30)) )
+    {
+      result.iterations = iterations;
+      result.ns_per_op = 1e9 * elapsed / iterations;
+      result.allocations_per_op = (double) num_allocations / iterations;
+      break;
+    }
+
+    // aim at min_time with the rate measured so far
+    const double estimate = (elapsed > 0.0) ? 1.2 * iterations * min_time / elapsed : 10.0 * iterations;
+    iterations = std::max(2 * iterations, (unsigned long) std::min(estimate, (double) (1ul << 30)));
+  }
+
+  printf("%-60s %12lu %12.1f %10.2f\n", result.name.c_str(), result.iterations, result.ns_per_op, result.allocations_per_op);
+  fflush(stdout);
+  return result;
+}
+
+
+struct ConvertPoseToPose2D
+{
+  const std::vector<geometry_msgs::Pose>* poses;
+
+  void operator()(unsigned long iterations)
+  {
+    geometry_msgs::Pose2D pose2D;
+    double sum = 0.0;
+    for(unsigned long i = 0; i < iterations; i++)
+    {
+      ompl_planner_base::convert((*poses)[i & (NUM_INPUTS - 1)], pose2D);
+      sum += pose2D.theta;
+    }
+    g_sink = g_sink + sum;
+  }
+};
+
+
+struct ConvertPose2DToPose
+{
+  const std::vector<geometry_msgs::Pose2D>* poses;
+
+  void operator()(unsigned long iterations)
+  {
+    geometry_msgs::Pose pose;
+    double sum = 0.0;
+    for(unsigned long i = 0; i < iterations; i++)
+    {
+      ompl_planner_base::convert((*poses)[i & (NUM_INPUTS - 1)], pose);
+      sum += pose.orientation.z;
+    }
+    g_sink = g_sink + sum;
+  }
+};
+
+
+struct ConvertStateToPose2D
+{
+  const std::vector<ompl::base::State*>* states;
+
+  void operator()(unsigned long iterations)
+  {
+    geometry_msgs::Pose2D pose2D;
+    double sum = 0.0;
+    for(unsigned long i = 0; i < iterations; i++)
+    {
+      ompl_planner_base::convert((*states)[i & (NUM_INPUTS - 1)], pose2D);
+      sum += pose2D.theta;
+    }
+    g_sink = g_sink + sum;
+  }
+};
+
+
+struct ConvertPose2DToScopedState
+{
+  const std::vector<geometry_msgs::Pose2D>* poses;
+  ompl::base::ScopedState<>* scoped_state;
+
+  void operator()(unsigned long iterations)
+  {
+    for(unsigned long i = 0; i < iterations; i++)
+    {
+      ompl_planner_base::convert((*poses)[i & (NUM_INPUTS - 1)], *scoped_state);
+    }
+    g_sink = g_sink + (*scoped_state)[0];
+  }
+};
+
+
+struct FootprintCost
+{
+  const ompl_planner_base::OMPLPlannerBase* planner;
+  const std::vector<geometry_msgs::Pose2D>* poses;
+
+  void operator()(unsigned long iterations)
+  {
+    double sum = 0.0;
+    for(unsigned long i = 0; i < iterations; i++)
+    {
+      sum += PlannerBenchmarkAccess::footprintCost(*planner, (*poses)[i & (NUM_INPUTS - 1)]);
+    }
+    g_sink = g_sink + sum;
+  }
+};
+
+
+struct IsStateValid
+{
+  const ompl_planner_base::OMPLPlannerBase* planner;
+  const std::vector<ompl::base::State*>* states;
+
+  void operator()(unsigned long iterations)
+  {
+    unsigned long num_valid = 0;
+    for(unsigned long i = 0; i < iterations; i++)
+    {
+      if(PlannerBenchmarkAccess::isStateValid2DGrid(*planner, (*states)[i & (NUM_INPUTS - 1)]))
+        num_valid++;
+    }
+    g_sink = g_sink + num_valid;
+  }
+};
+
+
+struct ConvertPath
+{
+  ompl_planner_base::OMPLPlannerBase* planner;
+  const ompl::geometric::PathGeometric* path;
+  std::vector<geometry_msgs::PoseStamped>* plan; // kept between calls like the plan of move_base
+
+  void operator()(unsigned long iterations)
+  {
+    for(unsigned long i = 0; i < iterations; i++)
+    {
+      PlannerBenchmarkAccess::convertPath(*planner, *path, *plan);
+    }
+    g_sink = g_sink + plan->size();
+  }
+};
+
+
+struct PublishPlan
+{
+  ompl_planner_base::OMPLPlannerBase* planner;
+  const std::vector<geometry_msgs::PoseStamped>* plan;
+
+  void operator()(unsigned long iterations)
+  {
+    for(unsigned long i = 0; i < iterations; i++)
+    {
+      PlannerBenchmarkAccess::publishPlan(*planner, *plan);
+    }
+  }
+};
+
+
+/**
+ * @brief Builds the message publishPlan publishes once somebody subscribed (without a ros master nothing can subscribe)
+ */
+struct BuildPlanMessage
+{
+  const std::vector<geometry_msgs::PoseStamped>* plan;
+
+  void operator()(unsigned long iterations)
+  {
+    for(unsigned long i = 0; i < iterations; i++)
+    {
+      nav_msgs::Path::Ptr gui_path(new nav_msgs::Path());
+      gui_path->header = (*plan)[0].header;
+      gui_path->poses = *plan;
+      g_sink = g_sink + gui_path->poses.size();
+    }
+  }
+};
+
+
+/**
+ * @brief Cost of a cell at a distance from the closest obstacle, decaying like the inflation layer of costmap_2d
+ */
+unsigned char inflationCost(double distance, double inscribed_radius, double cost_scaling_factor)
+{
+  if(distance <= 0.0)
+    return costmap_2d::LETHAL_OBSTACLE;
+  if(distance <= inscribed_radius)
+    return costmap_2d::INSCRIBED_INFLATED_OBSTACLE;
+  return (unsigned char) ((costmap_2d::INSCRIBED_INFLATED_OBSTACLE - 1) * exp(-cost_scaling_factor * (distance - inscribed_radius)));
+}
+
+
+/**
+ * @brief Fills a costmap with random lethal cells of the given density, inflated up to inflation_radius
+ */
+void createCostmap(double density, unsigned int size, double resolution, double inscribed_radius, double inflation_radius,
+                   ompl::RNG& rng, std::vector<unsigned char>& cells)
+{
+  cells.assign(size * size, costmap_2d::FREE_SPACE);
+  const int radius = (int) ceil(inflation_radius / resolution);
+  const unsigned int num_obstacles = (unsigned int) (density * size * size);
+  for(unsigned int i = 0; i < num_obstacles; i++)
+  {
+    const int ox = rng.uniformInt(0, size - 1);
+    const int oy = rng.uniformInt(0, size - 1);
+    for(int y = std::max(oy - radius, 0); y <= std::min(oy + radius, (int) size - 1); y++)
+    {
+      for(int x = std::max(ox - radius, 0); x <= std::min(ox + radius, (int) size - 1); x++)
+      {
+        const double distance = resolution * sqrt((double) ((x - ox) * (x - ox) + (y - oy) * (y - oy)));
+        if(distance > inflation_radius)
+          continue;
+        unsigned char& cell = cells[y * size + x];
+        cell = std::max(cell, inflationCost(distance, inscribed_radius, 10.0));
+      }
+    }
+  }
+}
+
+
+/**
+ * @brief Regular polygon as footprint
+ */
+std::vector<geometry_msgs::Point> createFootprint(double radius, unsigned int num_points)
+{
+  std::vector<geometry_msgs::Point> footprint(num_points);
+  for(unsigned int i = 0; i < num_points; i++)
+  {
+    const double angle = (i + 0.5) * 2.0 * M_PI / num_points;
+    footprint[i].x = radius * cos(angle);
+    footprint[i].y = radius * sin(angle);
+  }
+  return footprint;
+}
+
+
+/**
+ * Microbenchmarks of the inner loops of the plugin: validity and footprint checks across footprint sizes and costmap
+ * densities, the path conversion across path lengths and frame distances, the pose conversions and publishPlan.
+ * Everything runs on synthetic costmaps without a ros master. Prints ns and allocations per operation.
+ * Usage: microbenchmark_planner [min_time_per_benchmark (s, default 0.2)] [csv_file]
+ */
+int main(int argc, char** argv)
+{
+  const double min_time = (argc > 1) ? atof(argv[1]) : 0.2;
+  const std::string csv_file = (argc > 2) ? argv[2] : "";
+
+  // time stamps of the plans without ros::init
+  ros::Time::init();
+  ompl::RNG::setSeed(1);
+  ompl::RNG rng;
+
+  std::vector<BenchmarkResult> results;
+  printf("%-60s %12s %12s %10s\n", "benchmark", "iterations", "ns/op", "allocs/op");
+
+  // state space of the planner -> states and paths
+  ompl::base::StateSpacePtr space(new ompl::base::SE2StateSpace());
+  ompl::base::RealVectorBounds bounds(2);
+  bounds.setLow(0.0);
+  bounds.setHigh(1000.0);
+  space->as<ompl::base::SE2StateSpace>()->setBounds(bounds);
+  ompl::base::SpaceInformationPtr si(new ompl::base::SpaceInformation(space));
+
+  // synthetic costmap of 20 m x 20 m, poses keep the footprints on the map
+  const unsigned int size = 400;
+  const double resolution = 0.05;
+  std::vector<geometry_msgs::Pose2D> poses2D(NUM_INPUTS);
+  std::vector<geometry_msgs::Pose> poses(NUM_INPUTS);
+  std::vector<ompl::base::State*> states(NUM_INPUTS);
+  for(unsigned int i = 0; i < NUM_INPUTS; i++)
+  {
+    poses2D[i].x = rng.uniformReal(2.0, size * resolution - 2.0);
+    poses2D[i].y = rng.uniformReal(2.0, size * resolution - 2.0);
+    poses2D[i].theta = rng.uniformReal(-M_PI, M_PI);
+    ompl_planner_base::convert(poses2D[i], poses[i]);
+    states[i] = space->allocState();
+    states[i]->as<ompl::base::SE2StateSpace::StateType>()->setXY(poses2D[i].x, poses2D[i].y);
+    states[i]->as<ompl::base::SE2StateSpace::StateType>()->setYaw(poses2D[i].theta);
+  }
+
+  // conversions
+  {
+    ConvertPoseToPose2D pose_to_pose2D = {&poses};
+    results.push_back(runBenchmark("convert(Pose, Pose2D)", pose_to_pose2D, min_time));
+    ConvertPose2DToPose pose2D_to_pose = {&poses2D};
+    results.push_back(runBenchmark("convert(Pose2D, Pose)", pose2D_to_pose, min_time));
+    ConvertStateToPose2D state_to_pose2D = {&states};
+    results.push_back(runBenchmark("convert(State*, Pose2D)", state_to_pose2D, min_time));
+    ompl::base::ScopedState<> scoped_state(space);
+    ConvertPose2DToScopedState pose2D_to_scoped_state = {&poses2D, &scoped_state};
+    results.push_back(runBenchmark("convert(Pose2D, ScopedState)", pose2D_to_scoped_state, min_time));
+  }
+
+  // checks across footprint sizes, costmap densities and check modes
+  const double footprint_radii[] = {0.3, 0.6, 1.2};
+  const unsigned int footprint_points[] = {4, 8, 16};
+  const double densities[] = {0.0, 0.002, 0.01};
+  const char* mode_names[] = {"outline", "lookup_table", "tiered"};
+  for(unsigned int d = 0; d < 3; d++)
+  {
+    for(unsigned int f = 0; f < 3; f++)
+    {
+      // inflation as configured for the footprint: inscribed radius of the polygon, inflated up to the circumscribed radius + margin
+      const double circumscribed_radius = footprint_radii[f];
+      const double inscribed_radius = circumscribed_radius * cos(M_PI / footprint_points[f]);
+      std::vector<unsigned char> cells;
+      createCostmap(densities[d], size, resolution, inscribed_radius, circumscribed_radius + 0.25, rng, cells);
+      const ompl_planner_base::CostmapView costmap(&cells[0], size, size, resolution, 0.0, 0.0);
+      const std::vector<geometry_msgs::Point> footprint = createFootprint(footprint_radii[f], footprint_points[f]);
+      const unsigned int fast_accept_distance = PlannerBenchmarkAccess::getFastAcceptDistance(circumscribed_radius, resolution);
+      const unsigned char circumscribed_cost = inflationCost(fast_accept_distance * resolution, inscribed_radius, 10.0);
+
+      for(unsigned int m = 0; m < 3; m++)
+      {
+        ompl_planner_base::OMPLPlannerBase planner;
+        PlannerBenchmarkAccess::setupChecks(planner, costmap, footprint, (PlannerBenchmarkAccess::CheckMode) m,
+                                            fast_accept_distance, circumscribed_cost);
+
+        std::ostringstream suffix;
+        suffix << "/" << mode_names[m] << "/radius_" << footprint_radii[f] << "_points_" << footprint_points[f]
+               << "/density_" << densities[d];
+        if(m != PlannerBenchmarkAccess::TIERED)
+        {
+          // tiered mode only changes isStateValid2DGrid
+          FootprintCost footprint_cost = {&planner, &poses2D};
+          results.push_back(runBenchmark("footprintCost" + suffix.str(), footprint_cost, min_time));
+        }
+        IsStateValid is_state_valid = {&planner, &states};
+        results.push_back(runBenchmark("isStateValid2DGrid" + suffix.str(), is_state_valid, min_time));
+      }
+    }
+  }
+
+  // path conversion across path lengths (zig-zag with 1 m between the states) and frame distances
+  const unsigned int path_states[] = {10, 100, 1000};
+  const double frame_distances[] = {0.01, 0.05, 0.1};
+  for(unsigned int p = 0; p < 3; p++)
+  {
+    ompl::geometric::PathGeometric path(si);
+    ompl::base::State* state = space->allocState();
+    for(unsigned int i = 0; i < path_states[p]; i++)
+    {
+      state->as<ompl::base::SE2StateSpace::StateType>()->setXY(1.0 + 0.8 * i, 1.0 + 0.6 * (i % 2));
+      state->as<ompl::base::SE2StateSpace::StateType>()->setYaw((i % 2) ? 0.6435 : -0.6435);
+      path.append(state);
+    }
+    space->freeState(state);
+
+    for(unsigned int d = 0; d < 3; d++)
+    {
+      ompl_planner_base::OMPLPlannerBase planner;
+      PlannerBenchmarkAccess::setupInterpolation(planner, frame_distances[d]);
+      std::vector<geometry_msgs::PoseStamped> plan;
+      std::ostringstream suffix;
+      suffix << "/states_" << path_states[p] << "/max_dist_" << frame_distances[d];
+
+      ConvertPath convert_path = {&planner, &path, &plan};
+      results.push_back(runBenchmark("convertPath" + suffix.str(), convert_path, min_time));
+
+      std::ostringstream frames;
+      frames << "/frames_" << plan.size();
+      PublishPlan publish_plan = {&planner, &plan};
+      results.push_back(runBenchmark("publishPlan/no_subscriber" + frames.str(), publish_plan, min_time));
+      BuildPlanMessage build_plan_message = {&plan};
+      results.push_back(runBenchmark("publishPlan/message" + frames.str(), build_plan_message, min_time));
+    }
+  }
+
+  for(unsigned int i = 0; i < NUM_INPUTS; i++)
+  {
+    space->freeState(states[i]);
+  }
+
+  if(!csv_file.empty())
+  {
+    std::ofstream csv(csv_file.c_str());
+    if(!csv)
+    {
+      fprintf(stderr, "Could not open %s to write the results\n", csv_file.c_str());
+      return 1;
+    }
+    csv.precision(9);
+    csv << "benchmark,iterations,ns_per_op,allocations_per_op\n";
+    for(unsigned int i = 0; i < results.size(); i++)
+    {
+      csv << results[i].name << "," << results[i].iterations << "," << results[i].ns_per_op << "," << results[i].allocations_per_op << "\n";
+    }
+  }
+  return 0;
+}
@@ -37,10 +37,22 @@
 
 #include <ompl_planner_base/ompl_planner_base.h>
 #include <costmap_2d/layered_costmap.h>
+#include <costmap_2d/inflation_layer.h>
+#include <costmap_2d/cost_values.h>
+#include <base_local_planner/line_iterator.h>
+#include <dynamic_reconfigure/Config.h>
+#include <ompl/base/DiscreteMotionValidator.h>
 
 // pluginlib macros (defines, ...)
 #include <pluginlib/class_list_macros.h>
 
+// std c++ classes
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
 
 // register this planner as a BaseGlobalPlanner plugin
 // (see http://www.ros.org/wiki/pluginlib/Tutorials/Writing%20and%20Using%20a%20Simple%20Plugin)
@@ -50,33 +62,99 @@ PLUGINLIB_DECLARE_CLASS(ompl_planner_base, OMPLPlannerBase, ompl_planner_base::O
 namespace ompl_planner_base {
 
   OMPLPlannerBase::OMPLPlannerBase()
-    : costmap_ros_(NULL), initialized_(false){}
+    : costmap_ros_(NULL), planning_on_snapshot_(false), initialized_(false), circumscribed_cost_(0), fast_accept_distance_(0),
+      circumscribed_cost_current_(false), circumscribed_cost_radius_(0.0), circumscribed_cost_resolution_(0.0),
+      circumscribed_cost_inflation_radius_(0.0), unknown_blocks_size_x_(0),
+      validity_cache_max_footprint_cost_(0), validity_cache_tiered_(false),
+      setup_bounds_(2), setup_validity_check_resolution_(0.0), setup_cache_roadmap_(false), setup_planner_threads_(0),
+      config_changed_(false){}
 
   OMPLPlannerBase::OMPLPlannerBase(std::string name, costmap_2d::Costmap2DROS* costmap_ros)
-    : costmap_ros_(NULL), initialized_(false)
+    : costmap_ros_(NULL), planning_on_snapshot_(false), initialized_(false), circumscribed_cost_(0), fast_accept_distance_(0),
+      circumscribed_cost_current_(false), circumscribed_cost_radius_(0.0), circumscribed_cost_resolution_(0.0),
+      circumscribed_cost_inflation_radius_(0.0), unknown_blocks_size_x_(0),
+      validity_cache_max_footprint_cost_(0), validity_cache_tiered_(false),
+      setup_bounds_(2), setup_validity_check_resolution_(0.0), setup_cache_roadmap_(false), setup_planner_threads_(0),
+      config_changed_(false)
   {
     initialize(name, costmap_ros);
   }
 
   OMPLPlannerBase::~OMPLPlannerBase()
   {
-    delete world_model_;
+    stopAnytimeImprovement();
   }
 
   
-  void OMPLPlannerBase::readParameters()
+  void OMPLPlannerBase::reconfigureCB(OMPLPlannerBaseConfig& config, uint32_t level)
   {
-    private_nh_.param("max_dist_between_pathframes", max_dist_between_pathframes_, 0.10);
-    private_nh_.param("max_footprint_cost", max_footprint_cost_, 256);
-    private_nh_.param("relative_validity_check_resolution", relative_validity_check_resolution_, 0.004);
-    private_nh_.param("interpolate_path", interpolate_path_, true);
-    private_nh_.param("solver_maxtime", solver_maxtime_, 1.0);
+    // planner might be running -> only store configuration, it is applied at the start of the next query
+    boost::mutex::scoped_lock lock(config_mutex_);
+    config_ = config;
+    config_changed_ = true;
+  }
+
 
-    // check whether parameters have been set to valid values
-    if(max_dist_between_pathframes_ <= 0.0)
+  void OMPLPlannerBase::readParameters()
+  {
+    boost::mutex::scoped_lock lock(config_mutex_);
+    if(!config_changed_)
+      return;
+    config_changed_ = false;
+
+    max_dist_between_pathframes_ = config_.max_dist_between_pathframes;
+    max_footprint_cost_ = config_.max_footprint_cost;
+    relative_validity_check_resolution_ = config_.relative_validity_check_resolution;
+    interpolate_path_ = config_.interpolate_path;
+    solver_maxtime_ = config_.solver_maxtime;
+    use_footprint_lookup_table_ = config_.use_footprint_lookup_table;
+    footprint_lookup_yaw_bins_ = config_.footprint_lookup_yaw_bins;
+    use_tiered_validity_check_ = config_.use_tiered_validity_check;
+    persistent_setup_ = config_.persistent_setup;
+    cache_roadmap_ = config_.cache_roadmap;
+    planner_type_ = config_.global_planner_type;
+    planner_threads_ = config_.planner_threads;
+    use_costmap_snapshot_ = config_.use_costmap_snapshot;
+    motion_validation_mode_ = config_.motion_validation_mode;
+    use_validity_cache_ = config_.use_validity_cache;
+    validity_cache_max_megabytes_ = config_.validity_cache_max_megabytes;
+    reuse_last_plan_ = config_.reuse_last_plan;
+    replan_goal_tolerance_ = config_.replan_goal_tolerance;
+    replan_goal_yaw_tolerance_ = config_.replan_goal_yaw_tolerance;
+    replan_start_tolerance_ = config_.replan_start_tolerance;
+    simplify_maxtime_ = config_.simplify_maxtime;
+    use_grid_shortcuts_ = config_.use_grid_shortcuts;
+    anytime_planning_ = config_.anytime_planning;
+    anytime_first_solution_time_ = config_.anytime_first_solution_time;
+    anytime_improvement_time_ = config_.anytime_improvement_time;
+    profile_collision_checks_ = config_.profile_collision_checks;
+    use_connectivity_check_ = config_.use_connectivity_check;
+    use_coarse_to_fine_ = config_.use_coarse_to_fine;
+    coarse_downsampling_factor_ = config_.coarse_downsampling_factor;
+    coarse_corridor_width_ = config_.coarse_corridor_width;
+    coarse_corridor_bias_ = config_.coarse_corridor_bias;
+    use_region_of_interest_ = config_.use_region_of_interest;
+    batch_threads_ = config_.batch_threads;
+    roi_margin_ = config_.roi_margin;
+    roi_relative_margin_ = config_.roi_relative_margin;
+    roi_growth_factor_ = config_.roi_growth_factor;
+    enable_tracing_ = config_.enable_tracing;
+    trace_collision_checks_ = config_.trace_collision_checks;
+    record_requests_ = config_.record_requests;
+    formatParameters(config_, recorded_request_.parameters);
+    trace_.setEnabled(enable_tracing_);
+
+    // check whether parameters have been set to valid values (ranges are enforced by dynamic reconfigure)
+    if(use_validity_cache_ && !use_footprint_lookup_table_)
+    {
+      ROS_WARN("Validity cache requires use_footprint_lookup_table - validity cache disabled");
+      use_validity_cache_ = false;
+    }
+    if( (motion_validation_mode_.compare("discrete") != 0) && (motion_validation_mode_.compare("grid") != 0) &&
+        (motion_validation_mode_.compare("swept") != 0) )
     {
-      ROS_WARN("Assigned Distance for interpolation of path-frames invalid. Distance must be greater to 0. Distance set to default value: 0.10");
-      max_dist_between_pathframes_ = 0.10;
+      ROS_WARN("Assigned motion validation mode %s unknown. Mode must be discrete, grid or swept. Mode set to default value: discrete", motion_validation_mode_.c_str());
+      motion_validation_mode_ = "discrete";
     }
   }
 
@@ -102,12 +180,50 @@ namespace ompl_planner_base {
       // get costmap
       costmap_ros_ = costmap_ros;
       costmap_     = costmap_ros_->getCostmap();
-      world_model_ = new base_local_planner::CostmapModel(*costmap_);
+      costmap_view_ = CostmapView(*costmap_);
 
       // we'll get the parameters for the robot radius from the costmap we're associated with
       inscribed_radius_     = costmap_ros_->getLayeredCostmap()->getInscribedRadius();
       circumscribed_radius_ = costmap_ros_->getLayeredCostmap()->getCircumscribedRadius();
       footprint_spec_       = costmap_ros_->getRobotFootprint();
+
+      // parameters are configured through dynamic reconfigure, the server starts with the values on the parameter server
+      dsrv_ = boost::shared_ptr<dynamic_reconfigure::Server<OMPLPlannerBaseConfig> >(
+        new dynamic_reconfigure::Server<OMPLPlannerBaseConfig>(private_nh_));
+      dsrv_->setCallback(boost::bind(&OMPLPlannerBase::reconfigureCB, this, _1, _2));
+
+      // precompute the rasterized footprint if requested
+      readParameters();
+      updateFootprintLookupTable();
+      updateCircumscribedCost();
+
+      // warm up the cached PRM with a stored roadmap
+      private_nh_.param("roadmap_directory", roadmap_directory_, std::string(""));
+      save_roadmap_srv_ = private_nh_.advertiseService("save_roadmap", &OMPLPlannerBase::saveRoadmapService, this);
+
+      // events recorded per thread while tracing is enabled, dumped on request
+      int trace_buffer_size;
+      private_nh_.param("trace_buffer_size", trace_buffer_size, 16384);
+      trace_.setCapacity(std::max(trace_buffer_size, 1));
+      dump_trace_srv_ = private_nh_.advertiseService("dump_trace", &OMPLPlannerBase::dumpTraceService, this);
+
+      // ring of record files requests are appended to while record_requests is set
+      private_nh_.param("record_directory", record_directory_, std::string(""));
+      private_nh_.param("record_file_megabytes", record_file_megabytes_, 64);
+      private_nh_.param("record_file_count", record_file_count_, 4);
+
+      // many queries on one costmap snapshot, e.g. to estimate costs of candidate goals
+      make_plans_srv_ = private_nh_.advertiseService("make_plans", &OMPLPlannerBase::makePlansService, this);
+      make_plan_to_any_goal_srv_ = private_nh_.advertiseService("make_plan_to_any_goal", &OMPLPlannerBase::makePlanToAnyGoalService, this);
+
+      if(!roadmap_directory_.empty() && persistent_setup_ && cache_roadmap_ && (planner_type_.compare("PRM") == 0))
+      {
+        ompl::base::RealVectorBounds bounds(2);
+        getMapBounds(bounds);
+        updateSimpleSetup(bounds);
+        loadRoadmap();
+      }
+
       initialized_ = true;
     }
     else{
@@ -128,79 +244,97 @@ namespace ompl_planner_base {
       return false;
     }
 
-    // get parameters from prms-server for planner (robot-geometry + environment are obtained from coastmap)
+    // planner data might be accessed by service calls as well
+    boost::mutex::scoped_lock lock(planner_mutex_);
+
+    // worker of last query still improving its plan -> stop it, the best plan found so far is kept as last plan
+    stopAnytimeImprovement();
+    last_diagnostics_.reset();
+    last_statistics_.reset();
+
+    // apply parameters reconfigured since last query (robot-geometry + environment are obtained from coastmap)
+    ros::WallTime phase_start_time = ros::WallTime::now();
+    const boost::uint64_t trace_start_time = TraceBuffer::now();
     readParameters();
+    const double read_parameters_time = (ros::WallTime::now() - phase_start_time).toSec();
+    phase_start_time = ros::WallTime::now();
+
+    // tracing may just have been enabled -> phases are traced from here on
+    if(trace_.isEnabled())
+      trace_.setThreadName("makePlan");
+    TraceScope trace_plan(trace_, "makePlan");
+    trace_.recordComplete("read_parameters", trace_start_time);
+    TraceScope trace_setup(trace_, "setup");
 
     ROS_DEBUG("Got a start: %.2f, %.2f, and a goal: %.2f, %.2f", start.pose.position.x, start.pose.position.y, goal.pose.position.x, goal.pose.position.y);
 
     // clear path and get up to date copy of costmap
+    // (the anytime worker still checks motions after returning -> it always needs a copy owned by the planner)
     plan.clear();
-    costmap_ = costmap_ros_->getCostmap();
+    updateCostmap(use_costmap_snapshot_ || (anytime_planning_ && (anytime_improvement_time_ > 0.0)));
+
+    // reset counters of validity checker
+    validity_statistics_.reset();
 
     // make sure goal is set in the same frame, in which the map is set
     if(goal.header.frame_id != costmap_ros_->getGlobalFrameID()){
       ROS_ERROR("This planner as configured will only accept goals in the %s frame, but a goal was sent in the %s frame.",
                 costmap_ros_->getGlobalFrameID().c_str(), goal.header.frame_id.c_str());
+      discardLastPlan();
       return false;
     }
 
     // instantiate variables for statistics and diagnostics plotting
     ros::Time start_time, end_time;
 
-    ompl_planner_base::OMPLPlannerBaseStats msg_stats_ompl;
-    ompl_planner_base::OMPLPlannerDiagnostics msg_diag_ompl;
+    // messages are published as shared pointers -> no serialization for intra-process subscribers (not touched after publishing)
+    ompl_planner_base::OMPLPlannerBaseStats::Ptr msg_stats_ompl;
+    ompl_planner_base::OMPLPlannerDiagnostics::Ptr msg_diag_ompl;
+    if(publish_diagnostics_)
+    {
+      msg_stats_ompl = ompl_planner_base::OMPLPlannerBaseStats::Ptr(new ompl_planner_base::OMPLPlannerBaseStats());
+      msg_diag_ompl = ompl_planner_base::OMPLPlannerDiagnostics::Ptr(new ompl_planner_base::OMPLPlannerDiagnostics());
+    }
     start_time = ros::Time::now();
 
-    // create instance of the manifold to plan in -> for mobile base SE2
-    // 	ompl::base::StateManifoldPtr manifold(new ompl::base::SE2StateManifold());
-    ompl::base::StateSpacePtr manifold(new ompl::base::SE2StateSpace());
-
-    // get bounds from worldmap and set it to bounds for the planner
-    // as goal and map are set in same frame (checked above) we can directly get the extensions of the manifold from the map-prms
-    ompl::base::RealVectorBounds bounds(2);
-    double map_upperbound, map_lowerbound;
-
-    // get bounds for x coordinate
-    map_upperbound = costmap_->getSizeInMetersX() - costmap_->getOriginX();
-    map_lowerbound = map_upperbound - costmap_->getSizeInMetersX();
-    bounds.setHigh(0, map_upperbound);
-    bounds.setLow(0, map_lowerbound);
-    ROS_INFO("Setting upper and lower bounds of map x-coordinate to (%f, %f).", map_upperbound, map_lowerbound);
-
-    // get bounds for y coordinate
-    map_upperbound = costmap_->getSizeInMetersY() - costmap_->getOriginY();
-    map_lowerbound = map_upperbound - costmap_->getSizeInMetersY();
-    bounds.setHigh(1, map_upperbound);
-    bounds.setLow(1, map_lowerbound);
-    ROS_INFO("Setting upper and lower bounds of map y-coordinate to (%f, %f).", map_upperbound, map_lowerbound);
-
-    // now set it to the planner
-    // 	manifold->as<ompl::base::SE2StateManifold>()->setBounds(bounds);
-    manifold->as<ompl::base::SE2StateSpace>()->setBounds(bounds);
-
-    // now create instance to ompl setup
-    ompl::geometric::SimpleSetup simple_setup(manifold);
-
-    // set state validity checker
-    simple_setup.setStateValidityChecker(boost::bind(&OMPLPlannerBase::isStateValid2DGrid, this, _1));
-
-    // get SpaceInformationPointer from simple_setup (initialized in makePlan routine)
-    ompl::base::SpaceInformationPtr si_ptr = simple_setup.getSpaceInformation();
-
-    // set validity checking resolution
-    si_ptr->setStateValidityCheckingResolution(relative_validity_check_resolution_);
-
     // convert start and goal pose from ROS PoseStamped to ompl ScopedState for SE2
     // convert PoseStamped into Pose2D
     geometry_msgs::Pose2D start2D, goal2D;
     convert(start.pose, start2D);
     convert(goal.pose, goal2D);
 
+    // request is copied for the writer thread of the recorder -> no encoding or file access on this thread
+    if(record_requests_)
+      recordRequest(start2D, goal2D);
+
+    // get bounds from worldmap and set it to bounds for the planner
+    ompl::base::RealVectorBounds map_bounds(2);
+    getMapBounds(map_bounds);
+    ompl::base::RealVectorBounds bounds = map_bounds;
+
+    // restrict the state space to a region around start and goal (a cached roadmap has to span the whole map)
+    const bool use_roi = use_region_of_interest_ && !(persistent_setup_ && cache_roadmap_ && (planner_type_.compare("PRM") == 0));
+    double roi_scale = 1.0;
+    bool roi_covers_map = true;
+    if(use_roi)
+      roi_covers_map = getRegionBounds(start2D, goal2D, roi_scale, map_bounds, bounds);
+
+    // create (or reuse) state space, simple setup and planner for these bounds
+    updateSimpleSetup(bounds);
+    ompl::geometric::SimpleSetup& simple_setup = *simple_setup_;
+    const ompl::base::StateSpacePtr& manifold = simple_setup.getStateSpace();
+    state_pool_->beginQuery();
+    const double setup_time = (ros::WallTime::now() - phase_start_time).toSec();
+    phase_start_time = ros::WallTime::now();
+    trace_setup.end();
+    TraceScope trace_start_goal_check(trace_, "start_goal_check");
+
     // before starting planner -> check whether target configuration is collision-free
     int sample_costs = footprintCost(goal2D);
     if( (sample_costs < 0.0) || (sample_costs > max_footprint_cost_) )
     {
       ROS_ERROR("Collision on target: Planning aborted! Change target position.");
+      discardLastPlan();
       return false;
     }
     // before starting planner -> check whether start configuration is collision-free
@@ -208,17 +342,45 @@ namespace ompl_planner_base {
     if( (sample_costs < 0.0) || (sample_costs > max_footprint_cost_) )
     {
       ROS_ERROR("Collision on start: Planning aborted! Free start position.");
+      discardLastPlan();
+      return false;
+    }
+
+    // start and goal in different free regions (e.g. goal behind a closed door) -> no planner can find a path
+    unsigned int start_x, start_y, goal_x, goal_y;
+    if( use_connectivity_check_ && connectivity_index_.isValid() &&
+        costmap_view_.worldToMap(start2D.x, start2D.y, start_x, start_y) && costmap_view_.worldToMap(goal2D.x, goal2D.y, goal_x, goal_y) &&
+        !connectivity_index_.connected(start_x, start_y, goal_x, goal_y) )
+    {
+      ROS_WARN("Goal is not connected to start by free space: Planning aborted!");
+      discardLastPlan();
+
+      if(publish_diagnostics_)
+      {
+        msg_diag_ompl->summary = "Goal unreachable";
+        msg_diag_ompl->group = "base";
+        msg_diag_ompl->planner = planner_type_;
+        msg_diag_ompl->result = "unreachable";
+        msg_diag_ompl->goal_unreachable = true;
+        msg_diag_ompl->read_parameters_time = read_parameters_time;
+        msg_diag_ompl->setup_time = setup_time;
+        msg_diag_ompl->start_goal_check_time = (ros::WallTime::now() - phase_start_time).toSec();
+        msg_diag_ompl->state_allocator_size = state_pool_->getPeakBytes();
+        msg_diag_ompl->state_allocator_retained_size = state_pool_->getRetainedBytes();
+        last_diagnostics_ = msg_diag_ompl;
+        diagnostic_ompl_pub_.publish(msg_diag_ompl);
+      }
       return false;
     }
 
     if(publish_diagnostics_)
     {
       // set start and end pose, as well as distance between poses
-      msg_stats_ompl.start = start.pose;
-      msg_stats_ompl.goal = goal.pose;
+      msg_stats_ompl->start = start.pose;
+      msg_stats_ompl->goal = goal.pose;
       double diff_X = goal2D.x - start2D.x;
       double diff_Y = goal2D.y - start2D.y;
-      msg_stats_ompl.start_goal_dist = sqrt( diff_X*diff_X + diff_Y*diff_Y);
+      msg_stats_ompl->start_goal_dist = sqrt( diff_X*diff_X + diff_Y*diff_Y);
     }
 
     // convert Pose2D to ScopedState
@@ -238,6 +400,7 @@ namespace ompl_planner_base {
     if(!in_bound)
     {
       ROS_ERROR("Start Pose lies outside the bounds of the map - Aborting Planer");
+      discardLastPlan();
       return false;
     }
 
@@ -253,127 +416,224 @@ namespace ompl_planner_base {
     if(!in_bound)
     {
       ROS_ERROR("Target Pose lies outside the bounds of the map - Aborting Planer");
+      discardLastPlan();
       return false;
     }
 
     // set start and goal state to planner
     simple_setup.setStartAndGoalStates(ompl_scoped_state_start, ompl_scoped_state_goal);
+    const double start_goal_check_time = (ros::WallTime::now() - phase_start_time).toSec();
+    trace_start_goal_check.end();
+
+    // corridor of the last query does not apply anymore
+    if(corridor_)
+      corridor_->clear();
+
+    // moving towards the same goal as in the last query -> try to continue on the last plan
+    ompl::geometric::PathGeometric ompl_path(simple_setup.getSpaceInformation());
+    bool reused = false;
+    bool solved;
+    double planning_time;
+    std::string winning_planner;
+    int roi_attempts = use_roi ? 1 : 0;
+    TraceScope trace_solve(trace_, "solve");
+    if(reuse_last_plan_ || anytime_planning_)
+    {
+      const ros::WallTime reuse_start_time = ros::WallTime::now();
+      simple_setup.setup();
+      reused = reuseLastPlan(start2D, goal2D, simple_setup.getSpaceInformation(), ompl_path);
+      planning_time = (ros::WallTime::now() - reuse_start_time).toSec();
+      if(reused)
+        ROS_DEBUG("Reusing last plan, %d states remaining", (int) ompl_path.getStateCount());
+    }
 
-    // read desired planner-type from parameter server and set according planner to SimpleSetup
-    setPlannerType(simple_setup);
+    // coarse stage -> restrict most samples to a corridor around a path on the downsampled costmap
+    double coarse_planning_time = 0.0;
+    if(use_coarse_to_fine_ && !reused)
+    {
+      const ros::WallTime coarse_start_time = ros::WallTime::now();
+      if(!updateCorridor(start2D, goal2D))
+        ROS_DEBUG("No path on coarse grid - sampling uniformly");
+      coarse_planning_time = (ros::WallTime::now() - coarse_start_time).toSec();
+    }
 
     // finally --> plan a path (give ompl 1 second to find a valid path)
-    ROS_DEBUG("Requesting Plan");
-    bool solved = simple_setup.solve( solver_maxtime_ );
+    if(reused)
+    {
+      solved = true;
+    }
+    else
+    {
+      // attempts on the growing regions of interest share solver_maxtime -> a query without solution fails in time
+      unsigned int remaining_attempts = 1;
+      ompl::base::RealVectorBounds grown_bounds(2);
+      double grown_scale = roi_scale;
+      for(bool covers_map = roi_covers_map; !covers_map; remaining_attempts++)
+      {
+        grown_scale *= roi_growth_factor_;
+        covers_map = getRegionBounds(start2D, goal2D, grown_scale, map_bounds, grown_bounds);
+      }
+      const ros::WallTime solve_start_time = ros::WallTime::now();
+      solved = solve(simple_setup, solver_maxtime_ / remaining_attempts, winning_planner, planning_time);
+
+      // nothing found within the region of interest -> grow it (up to the bounds of the map) and plan again
+      while(!solved && !roi_covers_map)
+      {
+        remaining_attempts--;
+        const double remaining_time = solver_maxtime_ - (ros::WallTime::now() - solve_start_time).toSec();
+        if( (remaining_attempts == 0) || (remaining_time <= 0.0) )
+          break;
+
+        roi_scale *= roi_growth_factor_;
+        roi_covers_map = getRegionBounds(start2D, goal2D, roi_scale, map_bounds, bounds);
+        ROS_DEBUG("No path found in region of interest - growing it to (%f, %f) x (%f, %f)",
+                  bounds.low[0], bounds.high[0], bounds.low[1], bounds.high[1]);
+        updateStateSpaceBounds(bounds);
+        simple_setup.clear();
+        roi_attempts++;
+
+        double attempt_time;
+        solved = solve(simple_setup, remaining_time / remaining_attempts, winning_planner, attempt_time);
+        planning_time += attempt_time;
+      }
+    }
+    trace_solve.end();
+    trace_.record("validity_checks", TraceBuffer::COUNTER, validity_statistics_.get(ValidityStatistics::VALIDITY_CHECK));
 
     if(publish_diagnostics_)
     {
       // prepare diagnostic msg -> we do that before simplifying the plan to make sure we get the right computation time
-      msg_diag_ompl.summary = solved ? "Planning success" : "Planning Failed";
-      msg_diag_ompl.group = "base";
-      msg_diag_ompl.planner = planner_type_;
-      msg_diag_ompl.result = solved ? "success" : "failed";
-      msg_diag_ompl.planning_time = simple_setup.getLastPlanComputationTime();
+      msg_diag_ompl->summary = solved ? "Planning success" : "Planning Failed";
+      msg_diag_ompl->group = "base";
+      msg_diag_ompl->planner = planner_type_;
+      msg_diag_ompl->result = solved ? "success" : "failed";
+      msg_diag_ompl->planning_time = planning_time;
+      msg_diag_ompl->winning_planner = winning_planner;
+      msg_diag_ompl->reused_last_plan = reused;
+      msg_diag_ompl->read_parameters_time = read_parameters_time;
+      msg_diag_ompl->setup_time = setup_time;
+      msg_diag_ompl->start_goal_check_time = start_goal_check_time;
+      msg_diag_ompl->coarse_planning_time = coarse_planning_time;
+      msg_diag_ompl->coarse_corridor_cells = corridor_ ? corridor_->cells_x.size() : 0;
+      msg_diag_ompl->roi_attempts = roi_attempts;
+      msg_diag_ompl->roi_area_fraction = ((bounds.high[0] - bounds.low[0]) * (bounds.high[1] - bounds.low[1])) /
+                                         ((map_bounds.high[0] - map_bounds.low[0]) * (map_bounds.high[1] - map_bounds.low[1]));
+
+      // size of the data structure of the planner (of the first planner of a portfolio)
+      // PRMs report their size directly, other planners only export a copy of their data -> only done while profiling
+      const ompl::geometric::PRM* prm = dynamic_cast<const ompl::geometric::PRM*>(simple_setup.getPlanner().get());
+      if(!reused && prm)
+      {
+        msg_diag_ompl->planner_vertex_count = prm->milestoneCount();
+        msg_diag_ompl->planner_edge_count = prm->edgeCount();
+      }
+      else if(!reused && profile_collision_checks_)
+      {
+        ompl::base::PlannerData planner_data(simple_setup.getSpaceInformation());
+        simple_setup.getPlannerData(planner_data);
+        msg_diag_ompl->planner_vertex_count = planner_data.numVertices();
+        msg_diag_ompl->planner_edge_count = planner_data.numEdges();
+      }
     }
 
     if(!solved)
     {
       ROS_WARN("No path found");
+      discardLastPlan();
 
       if(publish_diagnostics_)
       {
         // but still publish diagnostics of ompl -> compose msg
-        msg_diag_ompl.trajectory_size = 0;
-        msg_diag_ompl.trajectory_duration = 0.0; // does not apply
+        msg_diag_ompl->trajectory_size = 0;
+        msg_diag_ompl->trajectory_duration = 0.0; // does not apply
+        fillCheckCounters(*msg_diag_ompl);
 
+        last_diagnostics_ = msg_diag_ompl;
         diagnostic_ompl_pub_.publish(msg_diag_ompl);
       }
       return false;
     }
 
-    // give ompl a chance to simplify the found solution
-    simple_setup.simplifySolution();
-
-    // if path found -> get resulting path
-    ompl::geometric::PathGeometric ompl_path(simple_setup.getSolutionPath());
-
-    if(publish_diagnostics_)
-    {
-      // finish composition of msg
-      msg_diag_ompl.trajectory_size = ompl_path.getStateCount();
-      msg_diag_ompl.trajectory_duration = 0.0; // does not apply
-      // publish msg
-      diagnostic_ompl_pub_.publish(msg_diag_ompl);
-    }
-
-    // convert into vector of pose2D
-    ROS_DEBUG("Converting Path from ompl PathGeometric format to vector of PoseStamped");
-    std::vector<geometry_msgs::Pose2D> temp_plan_Pose2D;
-    const int num_frames_inpath = (int) ompl_path.getStateCount();
-    temp_plan_Pose2D.reserve(num_frames_inpath);
-
-    for(int i = 0; i < num_frames_inpath; i++)
+    double simplification_time = 0.0;
+    unsigned int removed_vertices = 0;
+    if(!reused)
     {
-      geometry_msgs::Pose2D temp_pose;
-      // get frame and tranform it to Pose2D
-      convert(ompl_path.getState(i), temp_pose);
-
-      // output states for Debug
-      ROS_DEBUG("Coordinates of %dth frame: (x, y, theta) = (%f, %f, %f).", i, temp_pose.x, temp_pose.y, temp_pose.theta);
-
-      // and append them to plan
-      temp_plan_Pose2D.push_back(temp_pose);
-    }
+      // if path found -> get resulting path
+      ompl_path = simple_setup.getSolutionPath();
 
-    if(interpolate_path_)
-    {
-      ROS_DEBUG("Interpolating path to increase density of frames for local planning");
-      // interpolate between frames to meet density requirement of local_planner
-      const bool ipo_success = interpolatePathPose2D(temp_plan_Pose2D);
-      if(!ipo_success)
+      // give ompl a chance to simplify the found solution (done in the background in anytime mode)
+      if(!anytime_planning_)
       {
-        ROS_ERROR("Something went wrong during interpolation. Probably plan empty. Aborting!");
-        return false;
+        TraceScope trace_simplify(trace_, "simplify");
+        const ros::WallTime simplification_start_time = ros::WallTime::now();
+        removed_vertices = simplifyPath(*simple_setup.getPathSimplifier(), ompl_path);
+        simplification_time = (ros::WallTime::now() - simplification_start_time).toSec();
+        trace_simplify.end();
+        trace_.record("validity_checks", TraceBuffer::COUNTER, validity_statistics_.get(ValidityStatistics::VALIDITY_CHECK));
       }
-      ROS_DEBUG("Interpolated Path has %d frames", num_frames_inpath);
     }
 
-    // convert into vector of PoseStamped
-    std::vector<geometry_msgs::PoseStamped> temp_plan;
-    geometry_msgs::PoseStamped temp_pose_stamped;
-
-    for(int i = 0; i < num_frames_inpath; i++)
+    // keep vertices of the plan to continue on it in the next query
+    last_path_.resize(ompl_path.getStateCount());
+    for(unsigned int i = 0; i < last_path_.size(); i++)
     {
-      // set Frame to PoseStamped
-      ros::Time plan_time = ros::Time::now();
-
-      // set header
-      temp_pose_stamped.header.stamp = plan_time;
-      temp_pose_stamped.header.frame_id = costmap_ros_->getGlobalFrameID();
-
-      // convert Pose2D to pose and set to Pose of PoseStamped
-      convert(temp_plan_Pose2D[i], temp_pose_stamped.pose);
+      convert(ompl_path.getState(i), last_path_[i]);
+    }
+    last_goal_ = goal2D;
 
-      // append to plan
-      temp_plan.push_back(temp_pose_stamped);
+    // convert states (and interpolated frames) directly into the plan
+    phase_start_time = ros::WallTime::now();
+    TraceScope trace_convert(trace_, "convert");
+    ROS_DEBUG("Converting Path from ompl PathGeometric format to vector of PoseStamped");
+    if(!convertPath(ompl_path, costmap_ros_->getGlobalFrameID(), plan))
+    {
+      ROS_ERROR("Something went wrong during interpolation. Probably plan empty. Aborting!");
+      plan.clear();
+      discardLastPlan();
+      return false;
     }
+    ROS_DEBUG("Plan has %d frames", (int) plan.size());
+    const double conversion_time = (ros::WallTime::now() - phase_start_time).toSec();
+    trace_convert.end();
 
-    // done -> pass temp_plan to referenced variable plan ...
     ROS_INFO("Global planning finished: Path Found.");
-    plan = temp_plan;
 
     // publish the plan for visualization purposes ...
+    phase_start_time = ros::WallTime::now();
+    TraceScope trace_publish(trace_, "publish");
     publishPlan(plan);
+    const double publish_time = (ros::WallTime::now() - phase_start_time).toSec();
+    trace_publish.end();
+
+    if(publish_diagnostics_)
+    {
+      // finish composition of msg (counters include the checks of the simplification)
+      msg_diag_ompl->trajectory_size = ompl_path.getStateCount();
+      msg_diag_ompl->simplification_time = simplification_time;
+      msg_diag_ompl->simplification_removed_vertices = removed_vertices;
+      msg_diag_ompl->conversion_time = conversion_time;
+      msg_diag_ompl->publish_time = publish_time;
+      msg_diag_ompl->trajectory_duration = 0.0; // does not apply
+      fillCheckCounters(*msg_diag_ompl);
+      // publish msg
+      last_diagnostics_ = msg_diag_ompl;
+      diagnostic_ompl_pub_.publish(msg_diag_ompl);
+    }
+
+    // keep improving the plan while the robot starts moving, next query picks up the best plan found so far
+    if(anytime_planning_ && !reused)
+      startAnytimeImprovement(ompl_path);
 
     if(publish_diagnostics_)
     {
       // compose msg with stats
-      msg_stats_ompl.path_length = ompl_path.length();
+      msg_stats_ompl->path_length = ompl_path.length();
       // set end time for logging of planner statistics
       end_time = ros::Time::now();
       ros::Duration planning_duration = end_time - start_time;
-      msg_stats_ompl.total_planning_time = planning_duration.toSec();
+      msg_stats_ompl->total_planning_time = planning_duration.toSec();
       // publish statistics
+      last_statistics_ = msg_stats_ompl;
       stats_ompl_pub_.publish(msg_stats_ompl);
     }
 
@@ -381,183 +641,1749 @@ namespace ompl_planner_base {
     return true;
   }
 
-  double OMPLPlannerBase::footprintCost(const geometry_msgs::Pose2D& pose)
+  double OMPLPlannerBase::footprintCost(const geometry_msgs::Pose2D& pose) const
   {
     if(footprint_spec_.size() < 3){
       ROS_ERROR("We have no footprint... do nothing");
       return -1.0;
     }
 
-    // check the pose using the footprint_cost check
-    return world_model_->footprintCost(pose.x, pose.y, pose.theta,
-                                        footprint_spec_,
-                                        inscribed_radius_, circumscribed_radius_ );
-  }
+    // use precomputed outline if available
+    if(use_footprint_lookup_table_ && footprint_lookup_table_.isInitialized())
+    {
+      return footprint_lookup_table_.footprintCost(costmap_view_, pose.x, pose.y, pose.theta);
+    }
 
+    // check the pose the same way base_local_planner::CostmapModel does, but reentrant:
+    // the corners are transformed into a scratch buffer owned by the calling thread
+    std::vector<unsigned int>* corner_cells = footprint_scratch_.get();
+    if(corner_cells == NULL)
+    {
+      corner_cells = new std::vector<unsigned int>();
+      footprint_scratch_.reset(corner_cells);
+    }
+    corner_cells->resize(2 * footprint_spec_.size());
 
-  bool OMPLPlannerBase::isStateValid2DGrid(const ompl::base::State *state)
-  {
-    geometry_msgs::Pose2D checked_state;
-    convert(state, checked_state);
+    const double cos_th = cos(pose.theta);
+    const double sin_th = sin(pose.theta);
+    for(unsigned int i = 0; i < footprint_spec_.size(); i++)
+    {
+      const double wx = pose.x + (footprint_spec_[i].x * cos_th - footprint_spec_[i].y * sin_th);
+      const double wy = pose.y + (footprint_spec_[i].x * sin_th + footprint_spec_[i].y * cos_th);
 
-    double costs = footprintCost( checked_state );
+      // corner off the map -> footprint invalid
+      if(!costmap_view_.worldToMap(wx, wy, (*corner_cells)[2 * i], (*corner_cells)[2 * i + 1]))
+        return -1.0;
+    }
 
-    return ( (costs >= 0) && (costs < max_footprint_cost_) );
+    // now lay down the outline of the footprint in the costmap grid
+    unsigned char footprint_cost = 0;
+    for(unsigned int i = 0; i < footprint_spec_.size(); i++)
+    {
+      const unsigned int j = (i + 1) % footprint_spec_.size();
+      for(base_local_planner::LineIterator line((*corner_cells)[2 * i], (*corner_cells)[2 * i + 1],
+                                                (*corner_cells)[2 * j], (*corner_cells)[2 * j + 1]); line.isValid(); line.advance())
+      {
+        const unsigned char cost = costmap_view_.getCost(line.getX(), line.getY());
+        if( (cost == costmap_2d::LETHAL_OBSTACLE) || (cost == costmap_2d::NO_INFORMATION) )
+          return -1.0;
+        footprint_cost = std::max(footprint_cost, cost);
+      }
+    }
+
+    return footprint_cost;
   }
 
 
-  bool OMPLPlannerBase::interpolatePathPose2D(std::vector<geometry_msgs::Pose2D>& path)
+  bool OMPLPlannerBase::isStateValid2DGrid(const ompl::base::State *state) const
   {
-    std::vector<geometry_msgs::Pose2D> ipoPath;
-    geometry_msgs::Pose2D last_frame, curr_frame, diff_frame, temp_frame;
-    double frame_distance, num_insertions;
-    int path_size = path.size();
+    validity_statistics_.increment(ValidityStatistics::VALIDITY_CHECK);
+    if(!profile_collision_checks_)
+      return checkStateValidity(state);
+
+    const boost::uint64_t start_time = ValidityStatistics::now();
+    const bool valid = checkStateValidity(state);
+    validity_statistics_.increment(ValidityStatistics::VALIDITY_CHECK_TIME, ValidityStatistics::now() - start_time);
+    return valid;
+  }
 
-    // check whether path is correct - at least 2 Elements
-    if(path_size < 2)
-    {
-      ROS_ERROR("Path is not valid. It has only %d Elements. Interpolation not possible. Aborting.", path_size);
-      return false;
-    }
 
-    // init plan with start frame
-    ipoPath.push_back(path[0]);
+  bool OMPLPlannerBase::checkStateValidity(const ompl::base::State *state) const
+  {
+    geometry_msgs::Pose2D checked_state;
+    convert(state, checked_state);
 
-    // make sure plan is dense enough to be processed by local planner
-    for(int i = 1; i < path_size; i++)
+    if(use_tiered_validity_check_)
     {
-      // check wether current frame is close enough to last frame --> otherwise insert interpolated frames
-      last_frame = ipoPath[(ipoPath.size()-1)];
-      curr_frame = path[i];
+      unsigned int cell_x, cell_y;
+      if(!costmap_view_.worldToMap(checked_state.x, checked_state.y, cell_x, cell_y))
+      {
+        validity_statistics_.increment(ValidityStatistics::FAST_REJECT);
+        return false;
+      }
 
-      // calc distance between frames
-      diff_frame.x = curr_frame.x - last_frame.x;
-      diff_frame.y = curr_frame.y - last_frame.y;
-      diff_frame.theta = curr_frame.theta - last_frame.theta;
-      // normalize angle
-      diff_frame.theta = angles::normalize_angle(diff_frame.theta);
-      // calulate distance --> following is kind of a heuristic measure, ...
-      // ... as it only takes into account the euclidean distance in the cartesian coordinates
-      frame_distance = sqrt( diff_frame.x*diff_frame.x + diff_frame.y*diff_frame.y );
+      // center within inscribed radius of an obstacle -> footprint is in collision for sure
+      const unsigned char center_cost = costmap_view_.getCost(cell_x, cell_y);
+      if( (center_cost == costmap_2d::LETHAL_OBSTACLE) || (center_cost == costmap_2d::INSCRIBED_INFLATED_OBSTACLE) )
+      {
+        validity_statistics_.increment(ValidityStatistics::FAST_REJECT);
+        return false;
+      }
 
-      // insert frames until path is dense enough
-      if(frame_distance > max_dist_between_pathframes_)
+      // center further away from any obstacle than the footprint check reaches -> no lethal cell below the footprint.
+      // As inscribed cells may still lie below the footprint, this only holds if those are accepted as well.
+      // Unknown cells and the border of the map are not inflated -> checked explicitly.
+      if( (center_cost < circumscribed_cost_) && (max_footprint_cost_ > costmap_2d::INSCRIBED_INFLATED_OBSTACLE) &&
+          isKnownAround(cell_x, cell_y) )
       {
-        // just in case --> insert one frame more than neccesarry
-        num_insertions = ceil(frame_distance/max_dist_between_pathframes_);
-        //ROS_DEBUG("Distance between frames too large (%fm): Inserting %f frames.", frame_distance, num_insertions);
-        // n insertions create n+1 intervalls --> add one to division
-        diff_frame.x = diff_frame.x/(num_insertions + 1.0);
-        diff_frame.y = diff_frame.y/(num_insertions + 1.0);
-        diff_frame.theta = diff_frame.theta/(num_insertions + 1.0);
-        for(int j = 1; j <= (int)num_insertions; j++)
+        validity_statistics_.increment(ValidityStatistics::FAST_ACCEPT);
+        return true;
+      }
+    }
+
+    // result only depends on cell and yaw bin if the lookup table is used -> share it between all states of the cell and bin
+    unsigned int cell_index = 0, yaw_bin = 0;
+    bool use_cache = false;
+    if(validity_cache_.isAllocated() && footprint_lookup_table_.isInitialized())
+    {
+      unsigned int cell_x, cell_y;
+      if(costmap_view_.worldToMap(checked_state.x, checked_state.y, cell_x, cell_y))
+      {
+        cell_index = costmap_view_.getIndex(cell_x, cell_y);
+        yaw_bin = footprint_lookup_table_.getYawBin(checked_state.theta);
+        use_cache = true;
+
+        bool valid;
+        if(validity_cache_.lookup(cell_index, yaw_bin, valid))
         {
-          temp_frame.x = last_frame.x + j*diff_frame.x;
-          temp_frame.y = last_frame.y + j*diff_frame.y;
-          temp_frame.theta = last_frame.theta + j*diff_frame.theta;
-          // normalize angle
-          temp_frame.theta = angles::normalize_angle(temp_frame.theta);
-
-          // append frame to interpolated path
-          ipoPath.push_back(temp_frame);
+          validity_statistics_.increment(ValidityStatistics::CACHE_HIT);
+          return valid;
         }
+        validity_statistics_.increment(ValidityStatistics::CACHE_MISS);
       }
-
-      // finally insert frame from path
-      ipoPath.push_back(curr_frame);
     }
 
-    // done --> copy ipoPath to refernce-variable and return with true
-    path = ipoPath;
+    validity_statistics_.increment(ValidityStatistics::FOOTPRINT_CHECK);
+    double costs = footprintCost( checked_state );
+    const bool valid = ( (costs >= 0) && (costs < max_footprint_cost_) );
+
+    if(use_cache)
+      validity_cache_.insert(cell_index, yaw_bin, valid);
 
-    return true;
+    return valid;
   }
 
 
-  // Configuration
+  void OMPLPlannerBase::fillCheckCounters(ompl_planner_base::OMPLPlannerDiagnostics& msg) const
+  {
+    msg.validity_fast_reject_count = validity_statistics_.get(ValidityStatistics::FAST_REJECT);
+    msg.validity_fast_accept_count = validity_statistics_.get(ValidityStatistics::FAST_ACCEPT);
+    msg.validity_footprint_check_count = validity_statistics_.get(ValidityStatistics::FOOTPRINT_CHECK);
+    msg.validity_cache_hit_count = validity_statistics_.get(ValidityStatistics::CACHE_HIT);
+    msg.validity_cache_miss_count = validity_statistics_.get(ValidityStatistics::CACHE_MISS);
+    msg.validity_check_count = validity_statistics_.get(ValidityStatistics::VALIDITY_CHECK);
+    msg.validity_check_time = 1e-9 * validity_statistics_.get(ValidityStatistics::VALIDITY_CHECK_TIME);
+    msg.motion_check_count = validity_statistics_.get(ValidityStatistics::MOTION_CHECK);
+    msg.motion_check_time = 1e-9 * validity_statistics_.get(ValidityStatistics::MOTION_CHECK_TIME);
+    msg.state_allocator_size = state_pool_->getPeakBytes();
+    msg.state_allocator_retained_size = state_pool_->getRetainedBytes();
+  }
 
-  void OMPLPlannerBase::setPlannerType(ompl::geometric::SimpleSetup& simple_setup)
+
+  void OMPLPlannerBase::updateFootprintLookupTable()
   {
-    // set default planner
-    const std::string default_planner("LBKPIECE");
+    if(!use_footprint_lookup_table_)
+      return;
 
-    // read desired planner from parameter server
-    private_nh_.param("global_planner_type", planner_type_, default_planner);
+    const double resolution = costmap_->getResolution();
+    if(footprint_lookup_table_.matches(footprint_spec_, resolution, footprint_lookup_yaw_bins_))
+      return;
 
-    // get SpaceInformationPointer from simple_setup (initialized in makePlan routine)
-    const ompl::base::SpaceInformationPtr& si_ptr = simple_setup.getSpaceInformation();
+    // cached results have been computed with the old table
+    validity_cache_.invalidate();
 
-    // init according planner --> this is a little bit arkward, but as there is no switch/case for strings ...
+    if(footprint_lookup_table_.initialize(footprint_spec_, resolution, footprint_lookup_yaw_bins_))
+    {
+      ROS_INFO("Built footprint lookup table with %d yaw bins", footprint_lookup_yaw_bins_);
+    }
+    else
+    {
+      ROS_WARN("Could not build footprint lookup table (footprint needs at least 3 points) - falling back to costmap model");
+    }
+  }
 
-    ompl::base::PlannerPtr target_planner_ptr;
 
-    if(planner_type_.compare("EST") == 0)
+  void OMPLPlannerBase::updateCircumscribedCost()
+  {
+    if(!use_tiered_validity_check_)
     {
-      target_planner_ptr = ompl::base::PlannerPtr(new ompl::geometric::EST(si_ptr));
+      circumscribed_cost_ = 0;
+      circumscribed_cost_current_ = false;
+      return;
     }
-    else if(planner_type_.compare("KPIECE") == 0)
+
+    // the cost levels of the costmap are owned by the inflation layer
+    boost::shared_ptr<costmap_2d::InflationLayer> inflation_layer;
+    std::vector<boost::shared_ptr<costmap_2d::Layer> >* plugins = costmap_ros_->getLayeredCostmap()->getPlugins();
+    for(std::vector<boost::shared_ptr<costmap_2d::Layer> >::iterator plugin = plugins->begin(); !inflation_layer && (plugin != plugins->end()); ++plugin)
     {
-      target_planner_ptr = ompl::base::PlannerPtr(new ompl::geometric::KPIECE1(si_ptr));
+      inflation_layer = boost::dynamic_pointer_cast<costmap_2d::InflationLayer>(*plugin);
     }
-    else if(planner_type_.compare("LBKPIECE") == 0)
+    if(!inflation_layer)
     {
-      target_planner_ptr = ompl::base::PlannerPtr(new ompl::geometric::LBKPIECE1(si_ptr));
+      circumscribed_cost_ = 0;
+      circumscribed_cost_current_ = false;
+      ROS_WARN_ONCE("No inflation layer found in costmap - states can only be rejected early by the tiered validity check");
+      return;
     }
-    else if(planner_type_.compare("LazyRRT") == 0)
+
+    // cells beyond the inflation radius have no cost at all -> the inflation has to reach further than the footprint check
+    // (the cached parameter follows reconfigurations of the layer)
+    if(inflation_layer->getName() != inflation_layer_name_)
     {
-      target_planner_ptr = ompl::base::PlannerPtr(new ompl::geometric::LazyRRT(si_ptr));
+      inflation_layer_name_ = inflation_layer->getName();
+      inflation_layer_nh_ = ros::NodeHandle("~/" + inflation_layer_name_);
     }
-    else if(planner_type_.compare("pRRT") == 0)
+    double inflation_radius = 0.0;
+    if(!inflation_layer_nh_.getParamCached("inflation_radius", inflation_radius))
+      inflation_radius = 0.0;
+
+    // cost only depends on the footprint (circumscribed radius), the resolution and the inflation radius
+    const double resolution = costmap_->getResolution();
+    if( circumscribed_cost_current_ && (circumscribed_radius_ == circumscribed_cost_radius_) &&
+        (resolution == circumscribed_cost_resolution_) && (inflation_radius == circumscribed_cost_inflation_radius_) )
+      return;
+    circumscribed_cost_current_ = true;
+    circumscribed_cost_radius_ = circumscribed_radius_;
+    circumscribed_cost_resolution_ = resolution;
+    circumscribed_cost_inflation_radius_ = inflation_radius;
+
+    circumscribed_cost_ = 0;
+    fast_accept_distance_ = getFastAcceptDistance(circumscribed_radius_, resolution);
+    if(floor(inflation_radius / resolution) < fast_accept_distance_)
     {
-      target_planner_ptr = ompl::base::PlannerPtr(new ompl::geometric::pRRT(si_ptr));
+      ROS_WARN("Inflation radius does not cover the circumscribed radius plus %d cells - states are not accepted early by the tiered validity check",
+               FAST_ACCEPT_MARGIN_CELLS);
+      return;
     }
-    else if(planner_type_.compare("RRT") == 0)
+
+    // every cell with a lower cost is further away from the next obstacle than the footprint check reaches
+    circumscribed_cost_ = inflation_layer->computeCost(fast_accept_distance_);
+  }
+
+
+  unsigned int OMPLPlannerBase::getFastAcceptDistance(double circumscribed_radius, double resolution)
+  {
+    // cells of the outline lie up to about 1.5 cells further from the center cell than the circumscribed radius
+    // (offset of the center inside its cell, rasterization of the outline and the conservative lookup table)
+    return (unsigned int) ceil(circumscribed_radius / resolution) + FAST_ACCEPT_MARGIN_CELLS;
+  }
+
+
+  void OMPLPlannerBase::updateUnknownBlocks(bool map_comparable)
+  {
+    // blocks are not kept up to date while fast accept is off
+    if(circumscribed_cost_ == 0)
     {
-      target_planner_ptr = ompl::base::PlannerPtr(new ompl::geometric::RRT(si_ptr));
+      unknown_blocks_.clear();
+      return;
     }
-    else if(planner_type_.compare("RRTConnect") == 0)
+
+    const unsigned int size_x = costmap_view_.isValid() ? costmap_view_.getSizeInCellsX() : 0;
+    const unsigned int size_y = costmap_view_.isValid() ? costmap_view_.getSizeInCellsY() : 0;
+    const unsigned int blocks_size_x = (size_x + UNKNOWN_BLOCK_SIZE - 1) / UNKNOWN_BLOCK_SIZE;
+    const unsigned int blocks_size_y = (size_y + UNKNOWN_BLOCK_SIZE - 1) / UNKNOWN_BLOCK_SIZE;
+
+    // only the blocks overlapping the changes of the change tracker are scanned again
+    unsigned int min_bx = 0, min_by = 0, max_bx = blocks_size_x, max_by = blocks_size_y;
+    if( map_comparable && !unknown_blocks_.empty() && (blocks_size_x == unknown_blocks_size_x_) &&
+        (unknown_blocks_.size() == (size_t) blocks_size_x * blocks_size_y) )
     {
-      target_planner_ptr = ompl::base::PlannerPtr(new ompl::geometric::RRTConnect(si_ptr));
+      if(!costmap_change_tracker_.hasChanged())
+        return;
+
+      unsigned int min_x, min_y, max_x, max_y;
+      costmap_change_tracker_.getChangedBounds(min_x, min_y, max_x, max_y);
+      min_bx = min_x / UNKNOWN_BLOCK_SIZE;
+      min_by = min_y / UNKNOWN_BLOCK_SIZE;
+      max_bx = std::min(max_x / UNKNOWN_BLOCK_SIZE + 1, blocks_size_x);
+      max_by = std::min(max_y / UNKNOWN_BLOCK_SIZE + 1, blocks_size_y);
+    }
+    else
+    {
+      unknown_blocks_size_x_ = blocks_size_x;
+      unknown_blocks_.resize((size_t) blocks_size_x * blocks_size_y);
     }
-    else if(planner_type_.compare("pSBL") == 0)
+
+    const unsigned char* charmap = costmap_view_.getCharMap();
+    for(unsigned int by = min_by; by < max_by; by++)
     {
-      target_planner_ptr = ompl::base::PlannerPtr(new ompl::geometric::pSBL(si_ptr));
+      unsigned char* block_row = &unknown_blocks_[0] + (size_t) by * unknown_blocks_size_x_;
+      std::fill(block_row + min_bx, block_row + max_bx, 0);
+      for(unsigned int y = by * UNKNOWN_BLOCK_SIZE; y < std::min((by + 1) * UNKNOWN_BLOCK_SIZE, size_y); y++)
+      {
+        const unsigned char* row = charmap + (size_t) y * size_x;
+        for(unsigned int x = min_bx * UNKNOWN_BLOCK_SIZE; x < std::min(max_bx * UNKNOWN_BLOCK_SIZE, size_x); x++)
+        {
+          if(row[x] == costmap_2d::NO_INFORMATION)
+            block_row[x / UNKNOWN_BLOCK_SIZE] = 1;
+        }
+      }
     }
-    else if(planner_type_.compare("SBL") == 0)
+  }
+
+
+  bool OMPLPlannerBase::isKnownAround(unsigned int cell_x, unsigned int cell_y) const
+  {
+    // footprint check must stay on the map
+    const unsigned int distance = fast_accept_distance_;
+    if( unknown_blocks_.empty() || (cell_x < distance) || (cell_y < distance) ||
+        (cell_x + distance >= costmap_view_.getSizeInCellsX()) || (cell_y + distance >= costmap_view_.getSizeInCellsY()) )
+      return false;
+
+    // no unknown cell in any block overlapping the cells the footprint check reaches
+    for(unsigned int by = (cell_y - distance) / UNKNOWN_BLOCK_SIZE; by <= (cell_y + distance) / UNKNOWN_BLOCK_SIZE; by++)
     {
-      target_planner_ptr = ompl::base::PlannerPtr(new ompl::geometric::SBL(si_ptr));
+      for(unsigned int bx = (cell_x - distance) / UNKNOWN_BLOCK_SIZE; bx <= (cell_x + distance) / UNKNOWN_BLOCK_SIZE; bx++)
+      {
+        if(unknown_blocks_[(size_t) by * unknown_blocks_size_x_ + bx])
+          return false;
+      }
     }
-    else{
-      ROS_FATAL("The planner named [%s] passed in global_planner_type is not supported", planner_type_.c_str() );
+    return true;
+  }
+
+
+  unsigned int OMPLPlannerBase::getNumInsertions(const geometry_msgs::Pose2D& last_frame, const geometry_msgs::Pose2D& curr_frame) const
+  {
+    // following is kind of a heuristic measure, as it only takes into account the euclidean distance in the cartesian coordinates
+    const double diff_x = curr_frame.x - last_frame.x;
+    const double diff_y = curr_frame.y - last_frame.y;
+    const double frame_distance = sqrt( diff_x*diff_x + diff_y*diff_y );
+
+    // just in case --> insert one frame more than neccesarry
+    if(frame_distance > max_dist_between_pathframes_)
+      return (unsigned int) ceil(frame_distance/max_dist_between_pathframes_);
+
+    return 0;
+  }
+
+
+  bool OMPLPlannerBase::reuseLastPlan(const geometry_msgs::Pose2D& start, const geometry_msgs::Pose2D& goal,
+                                      const ompl::base::SpaceInformationPtr& si, ompl::geometric::PathGeometric& path)
+  {
+    if(last_path_.size() < 2)
+      return false;
+
+    // goal changed -> plan anew
+    const double goal_dx = goal.x - last_goal_.x;
+    const double goal_dy = goal.y - last_goal_.y;
+    if( (sqrt(goal_dx*goal_dx + goal_dy*goal_dy) > replan_goal_tolerance_) ||
+        (fabs(angles::shortest_angular_distance(goal.theta, last_goal_.theta)) > replan_goal_yaw_tolerance_) )
+      return false;
+
+    // find segment of the last plan closest to the start -> prefix up to it has already been travelled
+    unsigned int closest_segment = 0;
+    double closest_distance = -1.0;
+    for(unsigned int i = 0; (i + 1) < last_path_.size(); i++)
+    {
+      const double seg_dx = last_path_[i+1].x - last_path_[i].x;
+      const double seg_dy = last_path_[i+1].y - last_path_[i].y;
+      const double seg_length_sq = seg_dx*seg_dx + seg_dy*seg_dy;
+      double t = 0.0;
+      if(seg_length_sq > 0.0)
+        t = std::max(0.0, std::min(1.0, ((start.x - last_path_[i].x) * seg_dx + (start.y - last_path_[i].y) * seg_dy) / seg_length_sq));
+
+      const double dx = last_path_[i].x + t * seg_dx - start.x;
+      const double dy = last_path_[i].y + t * seg_dy - start.y;
+      const double distance = sqrt(dx*dx + dy*dy);
+      if( (closest_distance < 0.0) || (distance < closest_distance) )
+      {
+        closest_distance = distance;
+        closest_segment = i;
+      }
+    }
+
+    if(closest_distance > replan_start_tolerance_)
+    {
+      ROS_DEBUG("Start is %f m away from last plan - planning anew", closest_distance);
+      return false;
+    }
+
+    // remaining plan: start, vertices after the closest segment, goal (instead of the last vertex)
+    path.clear();
+    ompl::base::ScopedState<> scoped_state(si->getStateSpace());
+    convert(start, scoped_state);
+    path.append(scoped_state.get());
+    for(unsigned int i = closest_segment + 1; (i + 1) < last_path_.size(); i++)
+    {
+      convert(last_path_[i], scoped_state);
+      path.append(scoped_state.get());
+    }
+    convert(goal, scoped_state);
+    path.append(scoped_state.get());
+
+    // start has been checked before -> checking every motion covers all remaining vertices
+    for(unsigned int i = 0; (i + 1) < path.getStateCount(); i++)
+    {
+      if(!si->checkMotion(path.getState(i), path.getState(i + 1)))
+      {
+        ROS_DEBUG("Segment %d of last plan blocked - planning anew", i);
+        return false;
+      }
     }
 
-    simple_setup.setPlanner(target_planner_ptr);
+    return true;
   }
 
 
-  // Visualization
-  void OMPLPlannerBase::publishPlan(const std::vector<geometry_msgs::PoseStamped>& path)
+  // Configuration
+
+  void OMPLPlannerBase::updateSimpleSetup(const ompl::base::RealVectorBounds& bounds)
   {
-    // check whether there really is a path --> given an empty path we won't do anything
-    if(path.empty())
+    // check whether anything changed that invalidates the setup (and with it all data of the planner)
+    bool rebuild = !persistent_setup_ || !simple_setup_;
+    const bool bounds_changed = (bounds.low != setup_bounds_.low) || (bounds.high != setup_bounds_.high);
+    // region of interest moves with every query -> its bounds are set in place (a cached roadmap always spans the map)
+    rebuild = rebuild || (bounds_changed && (!use_region_of_interest_ || cached_prm_));
+    rebuild = rebuild || (relative_validity_check_resolution_ != setup_validity_check_resolution_);
+    rebuild = rebuild || (motion_validation_mode_ != setup_motion_validation_mode_);
+    rebuild = rebuild || (footprint_spec_.size() != setup_footprint_.size());
+    for(unsigned int i = 0; !rebuild && (i < footprint_spec_.size()); i++)
     {
-      ROS_INFO("Plan is empty - Nothing to display");
-      return;
+      rebuild = (footprint_spec_[i].x != setup_footprint_[i].x) || (footprint_spec_[i].y != setup_footprint_[i].y);
     }
 
-    // create a message for the plan
-    nav_msgs::Path gui_path;
-    gui_path.poses.resize(path.size());
-    gui_path.header.frame_id = path[0].header.frame_id;
-    gui_path.header.stamp = path[0].header.stamp;
+    // keep track of costmap changes for the roadmap and the validity cache (also on rebuild, to get a reference for the next query)
+    bool map_comparable = false;
+    if( (persistent_setup_ && cache_roadmap_) || use_validity_cache_ || use_connectivity_check_ || (circumscribed_cost_ > 0) )
+    {
+      // a snapshot lags behind the costmap -> track the cells actually planned on (changes after the copy are reported next query)
+      map_comparable = planning_on_snapshot_ ? costmap_change_tracker_.update(costmap_view_) : costmap_change_tracker_.update(*costmap_);
+    }
+    updateUnknownBlocks(map_comparable);
+    updateValidityCache(map_comparable);
+    updateConnectivityIndex(map_comparable);
 
-    // Extract the plan in world co-ordinates, we assume the path is all in the same frame
-    for(unsigned int i=0; i < path.size(); i++)
+    if(!rebuild && bounds_changed)
+      updateStateSpaceBounds(bounds);
+
+    // only the planner changed -> keep state space and simple setup, replace the planner
+    const bool replace_planner = (planner_type_ != setup_planner_type_) || (cache_roadmap_ != setup_cache_roadmap_) ||
+                                 (planner_threads_ != setup_planner_threads_);
+    if(!rebuild && replace_planner)
     {
-      gui_path.poses[i] = path[i];
+      ROS_DEBUG("Planner configuration changed - replacing planner of simple setup");
+      simple_setup_->clear();
+      setPlannerType(*simple_setup_);
+      setup_planner_type_ = planner_type_;
+      setup_cache_roadmap_ = cache_roadmap_;
+      setup_planner_threads_ = planner_threads_;
+      updateMotionValidator();
+      return;
     }
 
-    plan_pub_.publish(gui_path);
+    if(!rebuild && cached_prm_)
+    {
+      // keep the roadmap, only drop start and goal of last query and re-validate where the costmap changed
+      simple_setup_->getProblemDefinition()->clearSolutionPaths();
+      cached_prm_->clearQuery();
+      updateMotionValidator();
+      updateRoadmap(map_comparable);
+      return;
+    }
+
+    if(!rebuild)
+    {
+      // setup still valid -> only drop results of last query, but keep all allocated objects
+      ROS_DEBUG("Reusing state space, simple setup and planner of last query");
+      simple_setup_->clear();
+      updateMotionValidator();
+      return;
+    }
+
+    // create instance of the manifold to plan in -> for mobile base SE2 (states come from the pool kept across queries)
+    if(!state_pool_)
+      state_pool_ = StatePoolPtr(new StatePool());
+    state_space_ = ompl::base::StateSpacePtr(new PooledSE2StateSpace(state_pool_));
+
+    // now set bounds to the planner
+    state_space_->as<ompl::base::SE2StateSpace>()->setBounds(bounds);
+
+    // samples are drawn from the corridor of the coarse stage if there is one, uniformly otherwise
+    if(!corridor_)
+      corridor_ = CorridorPtr(new Corridor());
+    state_space_->setStateSamplerAllocator(boost::bind(&allocCorridorStateSampler, _1, corridor_));
+
+    // now create instance to ompl setup
+    simple_setup_ = ompl::geometric::SimpleSetupPtr(new ompl::geometric::SimpleSetup(state_space_));
+
+    // set state validity checker
+    simple_setup_->setStateValidityChecker(boost::bind(&OMPLPlannerBase::isStateValid2DGrid, this, _1));
+
+    // set validity checking resolution
+    simple_setup_->getSpaceInformation()->setStateValidityCheckingResolution(relative_validity_check_resolution_);
+
+    // set motion validator according to motion_validation_mode
+    ompl::base::SpaceInformation* si = simple_setup_->getSpaceInformation().get();
+    ompl::base::MotionValidatorPtr validator;
+    motion_validator_.reset();
+    swept_motion_validator_.reset();
+    if(motion_validation_mode_.compare("grid") == 0)
+    {
+      motion_validator_ = boost::shared_ptr<CostmapMotionValidator>(new CostmapMotionValidator(si));
+      validator = motion_validator_;
+    }
+    else if(motion_validation_mode_.compare("swept") == 0)
+    {
+      swept_motion_validator_ = boost::shared_ptr<SweptFootprintMotionValidator>(new SweptFootprintMotionValidator(si));
+      validator = swept_motion_validator_;
+    }
+    else
+    {
+      // what ompl would fall back to if no motion validator is set
+      validator = ompl::base::MotionValidatorPtr(new ompl::base::DiscreteMotionValidator(si));
+    }
+
+    // count (and time) all motion checks
+    profiling_motion_validator_ = boost::shared_ptr<ProfilingMotionValidator>(
+      new ProfilingMotionValidator(si, validator, &validity_statistics_));
+    simple_setup_->getSpaceInformation()->setMotionValidator(profiling_motion_validator_);
+    updateMotionValidator();
+
+    // set planner according to global_planner_type
+    setPlannerType(*simple_setup_);
+
+    // remember what this setup has been created for
+    setup_bounds_ = bounds;
+    setup_planner_type_ = planner_type_;
+    setup_validity_check_resolution_ = relative_validity_check_resolution_;
+    setup_footprint_ = footprint_spec_;
+    setup_cache_roadmap_ = cache_roadmap_;
+    setup_planner_threads_ = planner_threads_;
+    setup_motion_validation_mode_ = motion_validation_mode_;
+  }
+
+
+  void OMPLPlannerBase::updateMotionValidator()
+  {
+    if(profiling_motion_validator_)
+    {
+      profiling_motion_validator_->setTiming(profile_collision_checks_);
+      profiling_motion_validator_->setTrace(trace_collision_checks_ ? &trace_ : NULL);
+    }
+
+    if(swept_motion_validator_)
+      swept_motion_validator_->setCostmap(costmap_view_, footprint_spec_, max_footprint_cost_);
+
+    if(!motion_validator_)
+      return;
+
+    // samples may only be skipped if the footprint check works on the same discretization as the motion validator
+    const FootprintLookupTable* lookup_table = NULL;
+    if(use_footprint_lookup_table_ && footprint_lookup_table_.isInitialized())
+      lookup_table = &footprint_lookup_table_;
+
+    motion_validator_->setCostmap(costmap_view_, circumscribed_radius_, lookup_table);
+  }
+
+
+  void OMPLPlannerBase::updateValidityCache(bool map_comparable)
+  {
+    if(!use_validity_cache_ || (footprint_lookup_table_.getNumYawBins() > ValidityCache::MAX_YAW_BIN + 1))
+    {
+      // changes are not tracked while disabled -> entries can not be kept
+      if(validity_cache_.isAllocated())
+        validity_cache_.release();
+      return;
+    }
+
+    const size_t max_bytes = (size_t) validity_cache_max_megabytes_ * 1024 * 1024;
+    if(!validity_cache_.isAllocated() || (2 * validity_cache_.getMemoryUsage() <= max_bytes) || (validity_cache_.getMemoryUsage() > max_bytes))
+    {
+      if(!validity_cache_.allocate(max_bytes))
+        return;
+      ROS_DEBUG("Allocated validity cache with %d bytes", (int) validity_cache_.getMemoryUsage());
+    }
+    else if(!map_comparable || (max_footprint_cost_ != validity_cache_max_footprint_cost_) ||
+            (use_tiered_validity_check_ != validity_cache_tiered_))
+    {
+      validity_cache_.invalidate();
+    }
+    else if(costmap_change_tracker_.hasChanged())
+    {
+      // drop entries of all cells whose footprint may reach into the changed cells
+      unsigned int min_x, min_y, max_x, max_y;
+      costmap_change_tracker_.getChangedBounds(min_x, min_y, max_x, max_y);
+      const unsigned int margin = (unsigned int) ceil(circumscribed_radius_ / costmap_->getResolution()) + 1;
+      min_x = (min_x > margin) ? min_x - margin : 0;
+      min_y = (min_y > margin) ? min_y - margin : 0;
+      const unsigned int num_dropped = validity_cache_.invalidateRegion(costmap_->getSizeInCellsX(), min_x, min_y, max_x + margin, max_y + margin);
+      ROS_DEBUG("Dropped %d entries of validity cache in changed region", num_dropped);
+    }
+
+    validity_cache_max_footprint_cost_ = max_footprint_cost_;
+    validity_cache_tiered_ = use_tiered_validity_check_;
+  }
+
+
+  void OMPLPlannerBase::updateConnectivityIndex(bool map_comparable)
+  {
+    if(!use_connectivity_check_)
+    {
+      // changes are not tracked while disabled -> labels can not be kept
+      connectivity_index_.reset();
+      return;
+    }
+
+    // labels are computed from the copy of the change tracker -> consistent with the changes reported next time
+    const ros::WallTime start_time = ros::WallTime::now();
+    if(!map_comparable || !connectivity_index_.isValid())
+    {
+      connectivity_index_.build(costmap_change_tracker_.getReferenceView());
+      ROS_DEBUG("Built connectivity index in %f s", (ros::WallTime::now() - start_time).toSec());
+    }
+    else if(costmap_change_tracker_.hasChanged())
+    {
+      unsigned int min_x, min_y, max_x, max_y;
+      costmap_change_tracker_.getChangedBounds(min_x, min_y, max_x, max_y);
+      const bool incremental = connectivity_index_.update(costmap_change_tracker_.getReferenceView(), min_x, min_y, max_x, max_y);
+      ROS_DEBUG("%s connectivity index in %f s", incremental ? "Updated" : "Rebuilt", (ros::WallTime::now() - start_time).toSec());
+    }
+  }
+
+
+  bool OMPLPlannerBase::makePlans(const std::vector<geometry_msgs::PoseStamped>& starts,
+                                  const std::vector<geometry_msgs::PoseStamped>& goals,
+                                  std::vector<BatchPlanResult>& results, bool lengths_only)
+  {
+    if(!initialized_)
+    {
+      ROS_ERROR("The planner has not been initialized, please call initialize() to use the planner");
+      return false;
+    }
+
+    if( starts.empty() || ((starts.size() != 1) && (starts.size() != goals.size())) )
+    {
+      ROS_ERROR("A batch needs one start for all goals or one start per goal, got %d starts for %d goals", (int) starts.size(), (int) goals.size());
+      return false;
+    }
+
+    // make sure all poses are set in the same frame, in which the map is set
+    const std::string& global_frame = costmap_ros_->getGlobalFrameID();
+    for(unsigned int i = 0; i < std::max(starts.size(), goals.size()); i++)
+    {
+      if( ((i < starts.size()) && (starts[i].header.frame_id != global_frame)) || ((i < goals.size()) && (goals[i].header.frame_id != global_frame)) )
+      {
+        ROS_ERROR("This planner as configured will only accept queries in the %s frame", global_frame.c_str());
+        return false;
+      }
+    }
+
+    boost::mutex::scoped_lock lock(planner_mutex_);
+    stopAnytimeImprovement();
+
+    // parameters and costmap are the same for all queries of the batch
+    // (batches are also planned from service calls, outside of the lock move_base holds on the costmap -> always plan on a copy)
+    const ros::WallTime batch_start_time = ros::WallTime::now();
+    readParameters();
+    if(trace_.isEnabled())
+      trace_.setThreadName("makePlans");
+    TraceScope trace_batch(trace_, "makePlans");
+    updateCostmap(true);
+    validity_statistics_.reset();
+
+    // queries of a batch spread over the map -> no region of interest
+    ompl::base::RealVectorBounds bounds(2);
+    getMapBounds(bounds);
+    updateSimpleSetup(bounds);
+    ompl::geometric::SimpleSetup& simple_setup = *simple_setup_;
+    state_pool_->beginQuery();
+
+    BatchRun run;
+    run.next_query = 0;
+    run.results = &results;
+    run.lengths_only = lengths_only;
+    run.starts.resize(goals.size());
+    run.goals.resize(goals.size());
+    run.feasible.resize(goals.size());
+    results.assign(goals.size(), BatchPlanResult());
+
+    // queries no planner can solve are sorted out before (the connectivity index may only be used by one thread)
+    for(unsigned int i = 0; i < goals.size(); i++)
+    {
+      convert(starts[(starts.size() == 1) ? 0 : i].pose, run.starts[i]);
+      convert(goals[i].pose, run.goals[i]);
+      run.feasible[i] = isQueryFeasible(run.starts[i], run.goals[i]);
+    }
+
+    // roadmap of the cached PRM is grown by each query and the planners of a portfolio already run concurrently -> one query after the other
+    const unsigned int num_threads = std::min((unsigned int) std::max(batch_threads_, 1), (unsigned int) goals.size());
+    if( (num_threads > 1) && !cached_prm_ && portfolio_planners_.empty() )
+    {
+      simple_setup.setup();
+      boost::thread_group threads;
+      for(unsigned int i = 0; i < num_threads; i++)
+      {
+        threads.create_thread(boost::bind(&OMPLPlannerBase::runBatchWorker, this, &run));
+      }
+      threads.join_all();
+    }
+    else
+    {
+      for(unsigned int i = 0; i < goals.size(); i++)
+      {
+        if(!run.feasible[i])
+          continue;
+
+        // drop the results of the previous query (but keep the roadmap of the cached PRM)
+        if(cached_prm_)
+        {
+          simple_setup.getProblemDefinition()->clearSolutionPaths();
+          cached_prm_->clearQuery();
+        }
+        else
+        {
+          simple_setup.clear();
+        }
+
+        ompl::base::ScopedState<> start_state(simple_setup.getStateSpace()), goal_state(simple_setup.getStateSpace());
+        convert(run.starts[i], start_state);
+        convert(run.goals[i], goal_state);
+        simple_setup.setStartAndGoalStates(start_state, goal_state);
+
+        BatchPlanResult& result = results[i];
+        std::string winning_planner;
+        result.solved = solve(simple_setup, solver_maxtime_, winning_planner, result.planning_time);
+        if(!result.solved)
+          continue;
+
+        ompl::geometric::PathGeometric& path = simple_setup.getSolutionPath();
+        simplifyPath(*simple_setup.getPathSimplifier(), path);
+        result.length = path.length();
+        if(!lengths_only)
+          convertPath(path, costmap_ros_->getGlobalFrameID(), result.plan);
+      }
+    }
+
+    unsigned int num_solved = 0;
+    for(unsigned int i = 0; i < results.size(); i++)
+    {
+      if(results[i].solved)
+        num_solved++;
+    }
+    ROS_DEBUG("Batch planning finished: %d of %d queries solved in %f s", (int) num_solved, (int) results.size(),
+              (ros::WallTime::now() - batch_start_time).toSec());
+    return true;
+  }
+
+
+  bool OMPLPlannerBase::makePlanToAnyGoal(const geometry_msgs::PoseStamped& start,
+                                          const std::vector<geometry_msgs::PoseStamped>& goals,
+                                          std::vector<geometry_msgs::PoseStamped>& plan, int& goal_index)
+  {
+    plan.clear();
+    goal_index = -1;
+
+    if(!initialized_)
+    {
+      ROS_ERROR("The planner has not been initialized, please call initialize() to use the planner");
+      return false;
+    }
+
+    // make sure all poses are set in the same frame, in which the map is set
+    const std::string& global_frame = costmap_ros_->getGlobalFrameID();
+    bool same_frame = (start.header.frame_id == global_frame);
+    for(unsigned int i = 0; same_frame && (i < goals.size()); i++)
+    {
+      same_frame = (goals[i].header.frame_id == global_frame);
+    }
+    if(!same_frame)
+    {
+      ROS_ERROR("This planner as configured will only accept queries in the %s frame", global_frame.c_str());
+      return false;
+    }
+
+    boost::mutex::scoped_lock lock(planner_mutex_);
+    stopAnytimeImprovement();
+
+    // also called from service calls, outside of the lock move_base holds on the costmap -> always plan on a copy
+    readParameters();
+    if(trace_.isEnabled())
+      trace_.setThreadName("makePlanToAnyGoal");
+    TraceScope trace_plan(trace_, "makePlanToAnyGoal");
+    updateCostmap(true);
+    validity_statistics_.reset();
+
+    // goals may spread over the map -> no region of interest
+    ompl::base::RealVectorBounds bounds(2);
+    getMapBounds(bounds);
+    updateSimpleSetup(bounds);
+    ompl::geometric::SimpleSetup& simple_setup = *simple_setup_;
+    state_pool_->beginQuery();
+    const ompl::base::SpaceInformationPtr& si = simple_setup.getSpaceInformation();
+
+    // drop candidates no planner can reach before solving
+    geometry_msgs::Pose2D start2D, goal2D;
+    convert(start.pose, start2D);
+    std::vector<int> candidates;
+    std::vector<geometry_msgs::Pose2D> candidate_poses;
+    boost::shared_ptr<ompl::base::GoalStates> goal_states(new ompl::base::GoalStates(si));
+    ompl::base::ScopedState<> goal_state(simple_setup.getStateSpace());
+    for(unsigned int i = 0; i < goals.size(); i++)
+    {
+      convert(goals[i].pose, goal2D);
+      if(!isQueryFeasible(start2D, goal2D))
+        continue;
+
+      convert(goal2D, goal_state);
+      goal_states->addState(goal_state);
+      candidates.push_back(i);
+      candidate_poses.push_back(goal2D);
+    }
+
+    if(candidates.empty())
+    {
+      ROS_WARN("None of the %d goals can be reached from the start: Planning aborted!", (int) goals.size());
+      discardLastPlan();
+      return false;
+    }
+    ROS_DEBUG("Planning to any of %d goals (%d dropped)", (int) candidates.size(), (int) (goals.size() - candidates.size()));
+
+    ompl::base::ScopedState<> start_state(simple_setup.getStateSpace());
+    convert(start2D, start_state);
+    simple_setup.setStartState(start_state);
+    simple_setup.setGoal(goal_states);
+
+    std::string winning_planner;
+    double planning_time;
+    if(!solve(simple_setup, solver_maxtime_, winning_planner, planning_time))
+    {
+      ROS_WARN("No path found to any of the goals");
+      discardLastPlan();
+      return false;
+    }
+
+    ompl::geometric::PathGeometric& ompl_path = simple_setup.getSolutionPath();
+    simplifyPath(*simple_setup.getPathSimplifier(), ompl_path);
+
+    // goal reached is the candidate closest to the end of the path
+    const ompl::base::State* path_end = ompl_path.getState(ompl_path.getStateCount() - 1);
+    double min_distance = std::numeric_limits<double>::max();
+    unsigned int reached = 0;
+    for(unsigned int i = 0; i < goal_states->getStateCount(); i++)
+    {
+      const double distance = si->distance(path_end, goal_states->getState(i));
+      if(distance < min_distance)
+      {
+        min_distance = distance;
+        reached = i;
+      }
+    }
+    goal_index = candidates[reached];
+
+    // keep vertices of the plan to continue on it in the next query towards the same goal
+    last_path_.resize(ompl_path.getStateCount());
+    for(unsigned int i = 0; i < last_path_.size(); i++)
+    {
+      convert(ompl_path.getState(i), last_path_[i]);
+    }
+    last_goal_ = candidate_poses[reached];
+
+    if(!convertPath(ompl_path, costmap_ros_->getGlobalFrameID(), plan))
+    {
+      ROS_ERROR("Something went wrong during interpolation. Probably plan empty. Aborting!");
+      plan.clear();
+      goal_index = -1;
+      discardLastPlan();
+      return false;
+    }
+
+    ROS_INFO("Global planning finished: Path to goal %d of %d found in %f s.", goal_index, (int) goals.size(), planning_time);
+    publishPlan(plan);
+    return true;
+  }
+
+
+  void OMPLPlannerBase::runBatchWorker(BatchRun* run)
+  {
+    if(trace_.isEnabled())
+      trace_.setThreadName("batch planner");
+
+    // every thread solves its queries with its own planner, state space, validity checker and caches are shared
+    const ompl::base::SpaceInformationPtr& si = simple_setup_->getSpaceInformation();
+    ompl::base::PlannerPtr planner = createPlanner(planner_type_, si);
+    if(!planner)
+      return;
+    ompl::geometric::PathSimplifier simplifier(si);
+
+    while(true)
+    {
+      unsigned int index;
+      {
+        boost::mutex::scoped_lock lock(run->mutex);
+        if(run->next_query >= run->goals.size())
+          return;
+        index = run->next_query++;
+      }
+
+      if(!run->feasible[index])
+        continue;
+
+      ompl::base::ScopedState<> start_state(si->getStateSpace()), goal_state(si->getStateSpace());
+      convert(run->starts[index], start_state);
+      convert(run->goals[index], goal_state);
+      ompl::base::ProblemDefinitionPtr pdef(new ompl::base::ProblemDefinition(si));
+      pdef->setStartAndGoalStates(start_state, goal_state);
+
+      planner->clear();
+      planner->setProblemDefinition(pdef);
+      if(!planner->isSetup())
+        planner->setup();
+
+      BatchPlanResult& result = (*run->results)[index];
+      TraceScope trace_solve(trace_, "solve");
+      const ros::WallTime solve_start_time = ros::WallTime::now();
+      result.solved = planner->solve(solver_maxtime_);
+      result.planning_time = (ros::WallTime::now() - solve_start_time).toSec();
+      trace_solve.end();
+      if(!result.solved)
+        continue;
+
+      ompl::geometric::PathGeometric& path = *pdef->getSolutionPath()->as<ompl::geometric::PathGeometric>();
+      simplifyPath(simplifier, path);
+      result.length = path.length();
+      if(!run->lengths_only)
+        convertPath(path, costmap_ros_->getGlobalFrameID(), result.plan);
+    }
+  }
+
+
+  bool OMPLPlannerBase::isQueryFeasible(const geometry_msgs::Pose2D& start, const geometry_msgs::Pose2D& goal)
+  {
+    // start and goal have to be collision-free
+    int sample_costs = footprintCost(goal);
+    if( (sample_costs < 0.0) || (sample_costs > max_footprint_cost_) )
+      return false;
+    sample_costs = footprintCost(start);
+    if( (sample_costs < 0.0) || (sample_costs > max_footprint_cost_) )
+      return false;
+
+    // ... in the same free region
+    unsigned int start_x, start_y, goal_x, goal_y;
+    if( use_connectivity_check_ && connectivity_index_.isValid() &&
+        costmap_view_.worldToMap(start.x, start.y, start_x, start_y) && costmap_view_.worldToMap(goal.x, goal.y, goal_x, goal_y) &&
+        !connectivity_index_.connected(start_x, start_y, goal_x, goal_y) )
+      return false;
+
+    // ... and within the bounds of the state space
+    ompl::base::ScopedState<> state(state_space_);
+    convert(start, state);
+    if(!state_space_->satisfiesBounds(state.get()))
+      return false;
+    convert(goal, state);
+    return state_space_->satisfiesBounds(state.get());
+  }
+
+
+  void OMPLPlannerBase::setCostmapSnapshot(const CostmapSnapshotPtr& snapshot)
+  {
+    // worker of the last query may still plan on the old snapshot
+    boost::mutex::scoped_lock lock(planner_mutex_);
+    stopAnytimeImprovement();
+    external_snapshot_ = snapshot;
+  }
+
+
+  void OMPLPlannerBase::updateCostmap(bool use_snapshot)
+  {
+    costmap_ = costmap_ros_->getCostmap();
+    planning_on_snapshot_ = external_snapshot_ || use_snapshot;
+
+    if(external_snapshot_)
+    {
+      // snapshot shared with other planners -> only read
+      costmap_view_ = external_snapshot_->getView();
+    }
+    else if(use_snapshot)
+    {
+      // plan on a copy of the costmap -> lock of the costmap is only held while copying
+      // (buffer of the last snapshot is reused unless somebody else still holds it)
+      // the whole map is copied: the region of interest may grow up to the map within the query, and the change
+      // tracker, validity cache, connectivity index and roadmap work in cells of the whole map
+      // (a copy of the region would move its origin with every query and make the maps incomparable)
+      if(!costmap_snapshot_ || !costmap_snapshot_.unique())
+        costmap_snapshot_ = CostmapSnapshotPtr(new CostmapSnapshot());
+      costmap_snapshot_->copy(*costmap_);
+      costmap_view_ = costmap_snapshot_->getView();
+    }
+    else
+    {
+      costmap_view_ = CostmapView(*costmap_);
+    }
+
+    // footprint might have been changed since last query -> keep lookup table up to date
+    footprint_spec_ = costmap_ros_->getRobotFootprint();
+    circumscribed_radius_ = costmap_ros_->getLayeredCostmap()->getCircumscribedRadius();
+    updateFootprintLookupTable();
+    updateCircumscribedCost();
+  }
+
+
+  void OMPLPlannerBase::formatParameters(const OMPLPlannerBaseConfig& config, std::string& parameters)
+  {
+    dynamic_reconfigure::Config msg;
+    config.__toMessage__(msg);
+
+    std::ostringstream stream;
+    stream << std::setprecision(17);
+    for(unsigned int i = 0; i < msg.bools.size(); i++)
+    {
+      stream << "bool " << msg.bools[i].name << " " << (msg.bools[i].value ? "true" : "false") << "\n";
+    }
+    for(unsigned int i = 0; i < msg.ints.size(); i++)
+    {
+      stream << "int " << msg.ints[i].name << " " << msg.ints[i].value << "\n";
+    }
+    for(unsigned int i = 0; i < msg.doubles.size(); i++)
+    {
+      stream << "double " << msg.doubles[i].name << " " << msg.doubles[i].value << "\n";
+    }
+    for(unsigned int i = 0; i < msg.strs.size(); i++)
+    {
+      stream << "str " << msg.strs[i].name << " " << msg.strs[i].value << "\n";
+    }
+    parameters = stream.str();
+  }
+
+
+  void OMPLPlannerBase::recordRequest(const geometry_msgs::Pose2D& start, const geometry_msgs::Pose2D& goal)
+  {
+    if(!recorder_.isOpen())
+    {
+      if( record_directory_.empty() ||
+          !recorder_.open(record_directory_, (size_t) std::max(record_file_megabytes_, 1) * 1024 * 1024, std::max(record_file_count_, 1)) )
+      {
+        ROS_WARN("Requests can not be recorded - record_directory is not set or not writable. Recording disabled until reconfigured");
+        record_requests_ = false;
+        return;
+      }
+      ROS_INFO("Recording requests to %s", record_directory_.c_str());
+    }
+
+    recorded_request_.stamp = ros::Time::now().toSec();
+    recorded_request_.start = start;
+    recorded_request_.goal = goal;
+    recorded_request_.footprint = footprint_spec_;
+    if(!recorder_.record(recorded_request_, costmap_view_))
+      ROS_DEBUG("Recorder still busy with the previous request - request not recorded");
+  }
+
+
+  bool OMPLPlannerBase::updateCorridor(const geometry_msgs::Pose2D& start, const geometry_msgs::Pose2D& goal)
+  {
+    coarse_grid_planner_.update(costmap_view_, coarse_downsampling_factor_);
+
+    std::vector<unsigned int> coarse_path;
+    if(!coarse_grid_planner_.plan(start.x, start.y, goal.x, goal.y, coarse_path))
+      return false;
+
+    coarse_grid_planner_.getCorridor(coarse_path, coarse_corridor_width_, *corridor_);
+    corridor_->bias = coarse_corridor_bias_;
+    ROS_DEBUG("Coarse path with %d cells, sampling in corridor of %d cells", (int) coarse_path.size(), (int) corridor_->cells_x.size());
+    return true;
+  }
+
+
+  void OMPLPlannerBase::getMapBounds(ompl::base::RealVectorBounds& bounds)
+  {
+    // as goal and map are set in same frame (checked in makePlan) we can directly get the extensions of the manifold from the map-prms
+    double map_upperbound, map_lowerbound;
+
+    // get bounds for x coordinate (origin is the lower left corner of the map)
+    map_lowerbound = costmap_->getOriginX();
+    map_upperbound = map_lowerbound + costmap_->getSizeInMetersX();
+    bounds.setHigh(0, map_upperbound);
+    bounds.setLow(0, map_lowerbound);
+    ROS_INFO("Setting upper and lower bounds of map x-coordinate to (%f, %f).", map_upperbound, map_lowerbound);
+
+    // get bounds for y coordinate
+    map_lowerbound = costmap_->getOriginY();
+    map_upperbound = map_lowerbound + costmap_->getSizeInMetersY();
+    bounds.setHigh(1, map_upperbound);
+    bounds.setLow(1, map_lowerbound);
+    ROS_INFO("Setting upper and lower bounds of map y-coordinate to (%f, %f).", map_upperbound, map_lowerbound);
+  }
+
+
+  bool OMPLPlannerBase::getRegionBounds(const geometry_msgs::Pose2D& start, const geometry_msgs::Pose2D& goal, double scale,
+                                        const ompl::base::RealVectorBounds& map_bounds, ompl::base::RealVectorBounds& bounds)
+  {
+    // box spanned by start and goal, inflated by a margin growing with the distance between them
+    const double distance = hypot(goal.x - start.x, goal.y - start.y);
+    const double margin = scale * (roi_margin_ + roi_relative_margin_ * distance);
+
+    bounds.setLow(0, std::max(std::min(start.x, goal.x) - margin, map_bounds.low[0]));
+    bounds.setHigh(0, std::min(std::max(start.x, goal.x) + margin, map_bounds.high[0]));
+    bounds.setLow(1, std::max(std::min(start.y, goal.y) - margin, map_bounds.low[1]));
+    bounds.setHigh(1, std::min(std::max(start.y, goal.y) + margin, map_bounds.high[1]));
+
+    return (bounds.low == map_bounds.low) && (bounds.high == map_bounds.high);
+  }
+
+
+  void OMPLPlannerBase::updateStateSpaceBounds(const ompl::base::RealVectorBounds& bounds)
+  {
+    state_space_->as<ompl::base::SE2StateSpace>()->setBounds(bounds);
+
+    // extent of the space changed -> recompute the length of the segments between the states checked along a motion
+    state_space_->setup();
+    setup_bounds_ = bounds;
+  }
+
+
+  std::string OMPLPlannerBase::getRoadmapFileName()
+  {
+    // hash (FNV-1a) map geometry and footprint -> a roadmap is only loaded for the map and robot it has been built for
+    std::ostringstream key;
+    key << std::setprecision(9) << planner_type_ << " " << costmap_->getSizeInCellsX() << " " << costmap_->getSizeInCellsY() << " "
+        << costmap_->getResolution() << " " << costmap_->getOriginX() << " " << costmap_->getOriginY();
+    for(unsigned int i = 0; i < footprint_spec_.size(); i++)
+    {
+      key << " " << footprint_spec_[i].x << " " << footprint_spec_[i].y;
+    }
+
+    const std::string key_string = key.str();
+    unsigned long long hash = 14695981039346656037ULL;
+    for(unsigned int i = 0; i < key_string.size(); i++)
+    {
+      hash ^= (unsigned char) key_string[i];
+      hash *= 1099511628211ULL;
+    }
+
+    std::ostringstream file_name;
+    file_name << roadmap_directory_ << "/roadmap_" << std::hex << std::setw(16) << std::setfill('0') << hash << ".graph";
+    return file_name.str();
+  }
+
+
+  bool OMPLPlannerBase::loadRoadmap()
+  {
+    if(!cached_prm_)
+      return false;
+
+    const std::string file_name = getRoadmapFileName();
+    std::ifstream file(file_name.c_str(), std::ios::binary);
+    if(!file.good())
+    {
+      ROS_INFO("No stored roadmap found for this map and footprint (%s) - starting with empty roadmap", file_name.c_str());
+      return false;
+    }
+
+    // planner has to be set up to receive vertices
+    simple_setup_->setup();
+
+    ompl::base::PlannerData data(simple_setup_->getSpaceInformation());
+    ompl::base::PlannerDataStorage storage;
+    storage.load(file, data);
+
+    const unsigned int num_vertices = cached_prm_->loadRoadmap(data);
+
+    // map might have changed since the roadmap was stored -> re-validate all of it
+    updateRoadmap(false);
+
+    ROS_INFO("Loaded roadmap with %d vertices from %s", num_vertices, file_name.c_str());
+    return num_vertices > 0;
+  }
+
+
+  bool OMPLPlannerBase::saveRoadmapService(ompl_planner_base::SaveRoadmap::Request& req,
+                                           ompl_planner_base::SaveRoadmap::Response& res)
+  {
+    boost::mutex::scoped_lock lock(planner_mutex_);
+
+    if(!cached_prm_)
+    {
+      res.success = false;
+      res.message = "No roadmap available - roadmap is only kept by PRM with persistent_setup and cache_roadmap set";
+      return true;
+    }
+
+    std::string file_name = req.filename;
+    if(file_name.empty())
+    {
+      if(roadmap_directory_.empty())
+      {
+        res.success = false;
+        res.message = "Neither filename nor roadmap_directory given";
+        return true;
+      }
+      file_name = getRoadmapFileName();
+    }
+
+    ompl::base::PlannerData data(simple_setup_->getSpaceInformation());
+    cached_prm_->getPlannerData(data);
+
+    std::ofstream file(file_name.c_str(), std::ios::binary);
+    if(!file.good())
+    {
+      res.success = false;
+      res.message = "Could not open " + file_name + " for writing";
+      return true;
+    }
+    ompl::base::PlannerDataStorage storage;
+    storage.store(data, file);
+
+    std::ostringstream message;
+    message << "Stored roadmap with " << data.numVertices() << " vertices and " << data.numEdges() << " edges to " << file_name;
+    res.success = true;
+    res.message = message.str();
+    ROS_INFO("%s", res.message.c_str());
+    return true;
+  }
+
+
+  bool OMPLPlannerBase::dumpTraceService(ompl_planner_base::DumpTrace::Request& req,
+                                         ompl_planner_base::DumpTrace::Response& res)
+  {
+    // the trace buffer may be read while planning -> no need to wait for the planner
+    const std::string file_name = req.filename.empty() ? std::string("ompl_planner_base_trace.json") : req.filename;
+    if(!trace_.dump(file_name))
+    {
+      res.success = false;
+      res.message = "Could not write trace to " + file_name;
+      return true;
+    }
+
+    res.success = true;
+    res.message = trace_.isEnabled() ? "Trace written to " + file_name : "Tracing is disabled, wrote events recorded so far to " + file_name;
+    return true;
+  }
+
+
+  bool OMPLPlannerBase::makePlansService(ompl_planner_base::MakePlans::Request& req,
+                                         ompl_planner_base::MakePlans::Response& res)
+  {
+    std::vector<BatchPlanResult> results;
+    if(!makePlans(req.starts, req.goals, results, req.lengths_only))
+      return false;
+
+    res.solved.resize(results.size());
+    res.lengths.resize(results.size());
+    res.planning_times.resize(results.size());
+    if(!req.lengths_only)
+      res.paths.resize(results.size());
+    for(unsigned int i = 0; i < results.size(); i++)
+    {
+      res.solved[i] = results[i].solved;
+      res.lengths[i] = results[i].length;
+      res.planning_times[i] = results[i].planning_time;
+      if(req.lengths_only)
+        continue;
+
+      res.paths[i].header.frame_id = costmap_ros_->getGlobalFrameID();
+      res.paths[i].header.stamp = ros::Time::now();
+      res.paths[i].poses.swap(results[i].plan);
+    }
+    return true;
+  }
+
+
+  bool OMPLPlannerBase::makePlanToAnyGoalService(ompl_planner_base::MakePlanToAnyGoal::Request& req,
+                                                 ompl_planner_base::MakePlanToAnyGoal::Response& res)
+  {
+    int goal_index;
+    res.success = makePlanToAnyGoal(req.start, req.goals, res.path.poses, goal_index);
+    res.goal_index = goal_index;
+    res.path.header.frame_id = costmap_ros_->getGlobalFrameID();
+    res.path.header.stamp = ros::Time::now();
+    return true;
+  }
+
+
+  void OMPLPlannerBase::updateRoadmap(bool map_comparable)
+  {
+    if(map_comparable && !costmap_change_tracker_.hasChanged())
+    {
+      ROS_DEBUG("Costmap unchanged since last query - reusing roadmap as is");
+      return;
+    }
+
+    // get changed region in world coordinates
+    double min_x, min_y, max_x, max_y;
+    if(map_comparable)
+    {
+      unsigned int cell_min_x, cell_min_y, cell_max_x, cell_max_y;
+      costmap_change_tracker_.getChangedBounds(cell_min_x, cell_min_y, cell_max_x, cell_max_y);
+      costmap_->mapToWorld(cell_min_x, cell_min_y, min_x, min_y);
+      costmap_->mapToWorld(cell_max_x, cell_max_y, max_x, max_y);
+    }
+    else
+    {
+      // no reference to compare against -> whole map has to be re-validated
+      min_x = costmap_->getOriginX();
+      min_y = costmap_->getOriginY();
+      max_x = min_x + costmap_->getSizeInMetersX();
+      max_y = min_y + costmap_->getSizeInMetersY();
+    }
+
+    // every pose whose footprint may reach into the changed cells is affected
+    const double margin = circumscribed_radius_ + costmap_->getResolution();
+    const unsigned int num_removed_edges = cached_prm_->invalidateRegion(min_x - margin, min_y - margin, max_x + margin, max_y + margin);
+
+    ROS_DEBUG("Re-validated roadmap in region (%f, %f) - (%f, %f): %d edges removed", min_x, min_y, max_x, max_y, num_removed_edges);
+  }
+
+
+  void OMPLPlannerBase::setPlannerType(ompl::geometric::SimpleSetup& simple_setup)
+  {
+    // get SpaceInformationPointer from simple_setup (initialized in makePlan routine)
+    const ompl::base::SpaceInformationPtr& si_ptr = simple_setup.getSpaceInformation();
+
+    cached_prm_.reset();
+    portfolio_planners_.clear();
+    portfolio_planner_types_.clear();
+
+    // comma separated list of planners -> race all of them
+    if(planner_type_.find(',') != std::string::npos)
+    {
+      std::istringstream planner_list(planner_type_);
+      std::string planner_type;
+      while(std::getline(planner_list, planner_type, ','))
+      {
+        // strip whitespaces around planner names
+        const std::string::size_type first = planner_type.find_first_not_of(" \t");
+        const std::string::size_type last = planner_type.find_last_not_of(" \t");
+        if(first == std::string::npos)
+          continue;
+        planner_type = planner_type.substr(first, last - first + 1);
+
+        ompl::base::PlannerPtr planner_ptr = createPlanner(planner_type, si_ptr);
+        if(planner_ptr)
+        {
+          portfolio_planners_.push_back(planner_ptr);
+          portfolio_planner_types_.push_back(planner_type);
+        }
+      }
+
+      if(portfolio_planners_.empty())
+      {
+        ROS_FATAL("None of the planners [%s] passed in global_planner_type is supported", planner_type_.c_str());
+        return;
+      }
+
+      // simple setup still needs a planner to be set up, the planners run on their own problem definitions though
+      simple_setup.setPlanner(portfolio_planners_[0]);
+      return;
+    }
+
+    if( (planner_type_.compare("PRM") == 0) && persistent_setup_ && cache_roadmap_ )
+    {
+      // keep a handle to the planner to update its roadmap between queries
+      cached_prm_ = boost::shared_ptr<CachedPRM>(new CachedPRM(si_ptr));
+      simple_setup.setPlanner(cached_prm_);
+      return;
+    }
+
+    simple_setup.setPlanner(createPlanner(planner_type_, si_ptr));
+  }
+
+
+  ompl::base::PlannerPtr OMPLPlannerBase::createPlanner(const std::string& planner_type,
+                                                        const ompl::base::SpaceInformationPtr& si_ptr)
+  {
+    // init according planner --> this is a little bit arkward, but as there is no switch/case for strings ...
+
+    ompl::base::PlannerPtr target_planner_ptr;
+
+    if(planner_type.compare("EST") == 0)
+    {
+      target_planner_ptr = ompl::base::PlannerPtr(new ompl::geometric::EST(si_ptr));
+    }
+    else if(planner_type.compare("KPIECE") == 0)
+    {
+      target_planner_ptr = ompl::base::PlannerPtr(new ompl::geometric::KPIECE1(si_ptr));
+    }
+    else if(planner_type.compare("LBKPIECE") == 0)
+    {
+      target_planner_ptr = ompl::base::PlannerPtr(new ompl::geometric::LBKPIECE1(si_ptr));
+    }
+    else if(planner_type.compare("LazyRRT") == 0)
+    {
+      target_planner_ptr = ompl::base::PlannerPtr(new ompl::geometric::LazyRRT(si_ptr));
+    }
+    else if(planner_type.compare("pRRT") == 0)
+    {
+      ompl::geometric::pRRT* prrt = new ompl::geometric::pRRT(si_ptr);
+      prrt->setThreadCount(planner_threads_);
+      target_planner_ptr = ompl::base::PlannerPtr(prrt);
+    }
+    else if(planner_type.compare("RRT") == 0)
+    {
+      target_planner_ptr = ompl::base::PlannerPtr(new ompl::geometric::RRT(si_ptr));
+    }
+    else if(planner_type.compare("RRTConnect") == 0)
+    {
+      target_planner_ptr = ompl::base::PlannerPtr(new ompl::geometric::RRTConnect(si_ptr));
+    }
+    else if(planner_type.compare("pSBL") == 0)
+    {
+      ompl::geometric::pSBL* psbl = new ompl::geometric::pSBL(si_ptr);
+      psbl->setThreadCount(planner_threads_);
+      target_planner_ptr = ompl::base::PlannerPtr(psbl);
+    }
+    else if(planner_type.compare("SBL") == 0)
+    {
+      target_planner_ptr = ompl::base::PlannerPtr(new ompl::geometric::SBL(si_ptr));
+    }
+    else if(planner_type.compare("PRM") == 0)
+    {
+      target_planner_ptr = ompl::base::PlannerPtr(new ompl::geometric::PRM(si_ptr));
+    }
+    else{
+      ROS_FATAL("The planner named [%s] passed in global_planner_type is not supported", planner_type.c_str() );
+    }
+
+    return target_planner_ptr;
+  }
+
+
+  bool OMPLPlannerBase::solve(ompl::geometric::SimpleSetup& simple_setup, double max_time, std::string& winning_planner, double& planning_time)
+  {
+    bool solved;
+    if(!portfolio_planners_.empty())
+    {
+      ROS_DEBUG("Requesting Plan");
+
+      // race all planners of the portfolio
+      const ros::WallTime solve_start_time = ros::WallTime::now();
+      solved = solvePortfolio(simple_setup, max_time, winning_planner);
+      planning_time = (ros::WallTime::now() - solve_start_time).toSec();
+      if(solved)
+        ROS_DEBUG("Planner %s found the first solution of the portfolio", winning_planner.c_str());
+    }
+    else if(anytime_planning_ && (anytime_first_solution_time_ < max_time))
+    {
+      ROS_DEBUG("Requesting first solution");
+
+      // stop on the first exact solution (also for planners which keep optimizing), give the rest of max_time if none is found in time
+      solved = simple_setup.solve( ompl::base::plannerOrTerminationCondition(
+                                     ompl::base::timedPlannerTerminationCondition(anytime_first_solution_time_),
+                                     ompl::base::exactSolnPlannerTerminationCondition(simple_setup.getProblemDefinition())) );
+      planning_time = simple_setup.getLastPlanComputationTime();
+      if(!solved)
+      {
+        solved = simple_setup.solve( max_time - anytime_first_solution_time_ );
+        planning_time += simple_setup.getLastPlanComputationTime();
+      }
+      winning_planner = solved ? planner_type_ : "";
+    }
+    else
+    {
+      ROS_DEBUG("Requesting Plan");
+      solved = simple_setup.solve( max_time );
+      planning_time = simple_setup.getLastPlanComputationTime();
+      winning_planner = solved ? planner_type_ : "";
+    }
+    return solved;
+  }
+
+
+  bool OMPLPlannerBase::solvePortfolio(ompl::geometric::SimpleSetup& simple_setup, double max_time, std::string& winning_planner)
+  {
+    // set up space information and planners of the simple setup first (this also sets the problem definition of the first planner)
+    simple_setup.setup();
+    const ompl::base::ProblemDefinitionPtr& pdef = simple_setup.getProblemDefinition();
+
+    PortfolioRace race;
+    race.done = false;
+    race.exact = false;
+    race.difference = 0.0;
+
+    // every planner gets its own problem definition, so only the winning solution ends up in the one of the simple setup
+    for(unsigned int i = 0; i < portfolio_planners_.size(); i++)
+    {
+      ompl::base::ProblemDefinitionPtr planner_pdef(new ompl::base::ProblemDefinition(simple_setup.getSpaceInformation()));
+      planner_pdef->addStartState(pdef->getStartState(0));
+      planner_pdef->setGoal(pdef->getGoal());
+
+      portfolio_planners_[i]->clear();
+      portfolio_planners_[i]->setProblemDefinition(planner_pdef);
+      if(!portfolio_planners_[i]->isSetup())
+        portfolio_planners_[i]->setup();
+    }
+
+    // all planners stop as soon as the first exact solution is found
+    const ompl::base::PlannerTerminationCondition ptc = ompl::base::plannerOrTerminationCondition(
+          ompl::base::timedPlannerTerminationCondition(max_time),
+          ompl::base::PlannerTerminationCondition(boost::bind(&PortfolioRace::isDone, &race)));
+
+    boost::thread_group threads;
+    for(unsigned int i = 0; i < portfolio_planners_.size(); i++)
+    {
+      threads.create_thread(boost::bind(&OMPLPlannerBase::runPortfolioPlanner, this, i, boost::cref(ptc), &race));
+    }
+    threads.join_all();
+
+    if(!race.path)
+      return false;
+
+    pdef->addSolutionPath(race.path, !race.exact, race.difference);
+    winning_planner = race.winner;
+    return true;
+  }
+
+
+  void OMPLPlannerBase::runPortfolioPlanner(unsigned int index, const ompl::base::PlannerTerminationCondition& ptc, PortfolioRace* race)
+  {
+    if(trace_.isEnabled())
+      trace_.setThreadName("portfolio planner");
+    TraceScope trace_solve(trace_, "solve");
+    const ompl::base::PlannerStatus status = portfolio_planners_[index]->solve(ptc);
+    trace_solve.end();
+
+    const bool exact = (status == ompl::base::PlannerStatus::EXACT_SOLUTION);
+    if(!exact && (status != ompl::base::PlannerStatus::APPROXIMATE_SOLUTION))
+      return;
+
+    const ompl::base::ProblemDefinitionPtr& planner_pdef = portfolio_planners_[index]->getProblemDefinition();
+
+    boost::mutex::scoped_lock lock(race->mutex);
+
+    // take first exact solution, approximate solutions only if nothing better is found
+    if(!race->path || (exact && !race->exact))
+    {
+      race->path = planner_pdef->getSolutionPath();
+      race->exact = exact;
+      race->difference = planner_pdef->getSolutionDifference();
+      race->winner = portfolio_planner_types_[index];
+    }
+
+    if(exact)
+      race->done = true;
+  }
+
+
+  // Visualization
+  void OMPLPlannerBase::publishPlan(const std::vector<geometry_msgs::PoseStamped>& path)
+  {
+    // check whether there really is a path --> given an empty path we won't do anything
+    if(path.empty())
+    {
+      ROS_INFO("Plan is empty - Nothing to display");
+      return;
+    }
+
+    // nobody listening -> don't build the message at all
+    if(plan_pub_.getNumSubscribers() == 0)
+      return;
+
+    // create a message for the plan, published as shared pointer -> intra-process subscribers receive it without serialization
+    nav_msgs::Path::Ptr gui_path(new nav_msgs::Path());
+    gui_path->header = path[0].header;
+
+    // Extract the plan in world co-ordinates, we assume the path is all in the same frame
+    // (one copy is needed as long as somebody listens: the caller keeps the plan, subscribers may keep the message)
+    gui_path->poses = path;
+
+    plan_pub_.publish(gui_path);
+  }
+
+
+  unsigned int OMPLPlannerBase::simplifyPath(ompl::geometric::PathSimplifier& simplifier, ompl::geometric::PathGeometric& path)
+  {
+    const unsigned int num_states = path.getStateCount();
+
+    // no time limit -> simplify as long as there is an improvement
+    const ompl::base::PlannerTerminationCondition ptc = (simplify_maxtime_ > 0.0) ?
+      ompl::base::timedPlannerTerminationCondition(simplify_maxtime_) : ompl::base::plannerNonTerminatingCondition();
+
+    if(use_grid_shortcuts_)
+    {
+      shortcutPathOnGrid(path, ptc);
+    }
+    else if(simplify_maxtime_ > 0.0)
+    {
+      simplifier.simplify(path, ptc);
+    }
+    else
+    {
+      simplifier.simplifyMax(path);
+    }
+
+    return (path.getStateCount() < num_states) ? num_states - path.getStateCount() : 0;
+  }
+
+
+  unsigned int OMPLPlannerBase::shortcutPathOnGrid(ompl::geometric::PathGeometric& path, const ompl::base::PlannerTerminationCondition& ptc)
+  {
+    SweptFootprintMotionValidator line_of_sight(path.getSpaceInformation().get());
+    line_of_sight.setCostmap(costmap_view_, footprint_spec_, max_footprint_cost_);
+
+    std::vector<ompl::base::State*>& states = path.getStates();
+    const ompl::base::SpaceInformationPtr& si = path.getSpaceInformation();
+    unsigned int num_removed = 0;
+
+    // vertices of the path are valid -> only the swept area of the shortcut needs to be checked
+    for(unsigned int i = 0; ((i + 2) < states.size()) && !ptc; i++)
+    {
+      for(unsigned int j = states.size() - 1; (j > i + 1) && !ptc; j--)
+      {
+        if(!line_of_sight.checkMotion(states[i], states[j]))
+          continue;
+
+        for(unsigned int k = i + 1; k < j; k++)
+        {
+          si->freeState(states[k]);
+        }
+        states.erase(states.begin() + i + 1, states.begin() + j);
+        num_removed += j - i - 1;
+        break;
+      }
+    }
+
+    return num_removed;
+  }
+
+
+  bool OMPLPlannerBase::convertPath(const ompl::geometric::PathGeometric& path, const std::string& frame_id,
+                                    std::vector<geometry_msgs::PoseStamped>& plan)
+  {
+    const unsigned int num_states = path.getStateCount();
+
+    // check whether path is correct - at least 2 Elements
+    if(interpolate_path_ && (num_states < 2))
+    {
+      ROS_ERROR("Path is not valid. It has only %d Elements. Interpolation not possible. Aborting.", num_states);
+      return false;
+    }
+
+    // first pass: count frames to size the plan once
+    unsigned int num_frames = num_states;
+    geometry_msgs::Pose2D last_frame, curr_frame;
+    if(interpolate_path_)
+    {
+      convert(path.getState(0), last_frame);
+      for(unsigned int i = 1; i < num_states; i++)
+      {
+        convert(path.getState(i), curr_frame);
+        num_frames += getNumInsertions(last_frame, curr_frame);
+        last_frame = curr_frame;
+      }
+    }
+
+    // all frames share one header
+    plan.resize(num_frames);
+    std_msgs::Header header;
+    header.stamp = ros::Time::now();
+    header.frame_id = frame_id;
+
+    // second pass: write states and interpolated frames in place
+    unsigned int frame = 0;
+    for(unsigned int i = 0; i < num_states; i++)
+    {
+      convert(path.getState(i), curr_frame);
+
+      // make sure plan is dense enough to be processed by local planner
+      const unsigned int num_insertions = (interpolate_path_ && (i > 0)) ? getNumInsertions(last_frame, curr_frame) : 0;
+      if(num_insertions > 0)
+      {
+        // n insertions create n+1 intervalls --> add one to division
+        const double step_x = (curr_frame.x - last_frame.x) / (num_insertions + 1.0);
+        const double step_y = (curr_frame.y - last_frame.y) / (num_insertions + 1.0);
+        const double step_theta = angles::normalize_angle(curr_frame.theta - last_frame.theta) / (num_insertions + 1.0);
+        for(unsigned int j = 1; j <= num_insertions; j++)
+        {
+          geometry_msgs::Pose2D temp_frame;
+          temp_frame.x = last_frame.x + j*step_x;
+          temp_frame.y = last_frame.y + j*step_y;
+          temp_frame.theta = angles::normalize_angle(last_frame.theta + j*step_theta);
+
+          plan[frame].header = header;
+          convert(temp_frame, plan[frame].pose);
+          frame++;
+        }
+      }
+
+      plan[frame].header = header;
+      convert(curr_frame, plan[frame].pose);
+      frame++;
+
+      last_frame = curr_frame;
+    }
+
+    return true;
+  }
+
+
+  void OMPLPlannerBase::startAnytimeImprovement(const ompl::geometric::PathGeometric& path)
+  {
+    if(anytime_improvement_time_ <= 0.0)
+      return;
+
+    ompl::geometric::PathGeometricPtr worker_path(new ompl::geometric::PathGeometric(path));
+    anytime_thread_ = boost::shared_ptr<boost::thread>(
+      new boost::thread(boost::bind(&OMPLPlannerBase::runAnytimeImprovement, this, worker_path)));
+  }
+
+
+  void OMPLPlannerBase::discardLastPlan()
+  {
+    stopAnytimeImprovement();
+    last_path_.clear();
+  }
+
+
+  void OMPLPlannerBase::stopAnytimeImprovement()
+  {
+    if(!anytime_thread_)
+      return;
+
+    anytime_thread_->interrupt();
+    anytime_thread_->join();
+    anytime_thread_.reset();
+  }
+
+
+  void OMPLPlannerBase::runAnytimeImprovement(ompl::geometric::PathGeometricPtr path)
+  {
+    if(trace_.isEnabled())
+      trace_.setThreadName("anytime worker");
+
+    ompl::geometric::PathSimplifier simplifier(simple_setup_->getSpaceInformation());
+    const ros::WallTime end_time = ros::WallTime::now() + ros::WallDuration(anytime_improvement_time_);
+
+    // stop after a few rounds without improvement, the shortcuts are random
+    const unsigned int max_failed_rounds = 3;
+    unsigned int failed_rounds = 0;
+    while( !boost::this_thread::interruption_requested() && (ros::WallTime::now() < end_time) && (failed_rounds < max_failed_rounds) )
+    {
+      TraceScope trace_round(trace_, "improve");
+      const double length = path->length();
+      simplifier.reduceVertices(*path);
+      if(!boost::this_thread::interruption_requested())
+        simplifier.shortcutPath(*path);
+
+      if(path->length() >= length - 1e-6)
+      {
+        failed_rounds++;
+        continue;
+      }
+      failed_rounds = 0;
+
+      // store improved plan (makePlan only reads it after joining this thread) and show it
+      last_path_.resize(path->getStateCount());
+      for(unsigned int i = 0; i < last_path_.size(); i++)
+      {
+        convert(path->getState(i), last_path_[i]);
+      }
+
+      std::vector<geometry_msgs::PoseStamped> plan;
+      if(convertPath(*path, costmap_ros_->getGlobalFrameID(), plan))
+        publishPlan(plan);
+
+      ROS_DEBUG("Improved plan in background to length %f", path->length());
+    }
   }
 
 
@@ -0,0 +1,373 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#include <ompl_planner_base/pooled_state_space.h>
+#include <ompl/base/spaces/RealVectorStateSpace.h>
+#include <ompl/base/spaces/SO2StateSpace.h>
+
+// boost classes
+#include <boost/thread/mutex.hpp>
+
+// std c++ classes
+#include <stdlib.h>
+#include <algorithm>
+#include <deque>
+#include <new>
+#include <vector>
+
+
+namespace ompl_planner_base {
+
+  /**
+   * @brief One SE2 state with its components, the compound state comes first so a state pointer is the block pointer
+   */
+  struct StatePool::Block
+  {
+    ompl::base::SE2StateSpace::StateType state;
+    ompl::base::State* components[2];
+    ompl::base::RealVectorStateSpace::StateType position;
+    double position_values[2];
+    ompl::base::SO2StateSpace::StateType yaw;
+    Chunk* chunk;
+    Block* next_free;
+
+    Block(Chunk* chunk_in) : chunk(chunk_in), next_free(NULL)
+    {
+      position.values = position_values;
+      components[0] = &position;
+      components[1] = &yaw;
+      state.components = components;
+    }
+  };
+
+
+  struct StatePool::Chunk
+  {
+    Block* blocks;
+    unsigned int num_free; ///< @brief blocks of the chunk in the central free list
+    bool released;
+  };
+
+
+  /**
+   * @brief Chunks and central free list of the pool, blocks are handed to the thread caches in batches
+   */
+  class StatePool::Central : private boost::noncopyable {
+
+  public:
+    static const unsigned int BLOCKS_PER_CHUNK = 1024;
+    static const unsigned int BATCH_SIZE = 64;
+
+    Central(unsigned int history_length)
+      : free_list_(NULL), num_out_(0), peak_out_(0), history_length_(std::max(history_length, 1u)){}
+
+    ~Central()
+    {
+      for(unsigned int i = 0; i < chunks_.size(); i++)
+      {
+        freeChunk(chunks_[i]);
+      }
+    }
+
+    /**
+     * @brief Takes a batch of BATCH_SIZE blocks from the free list, allocating chunks if needed
+     * @return First block of the batch, the blocks are linked by next_free
+     */
+    Block* take()
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      Block* batch = NULL;
+      for(unsigned int i = 0; i < BATCH_SIZE; i++)
+      {
+        if(free_list_ == NULL)
+          addChunk();
+        Block* block = free_list_;
+        free_list_ = block->next_free;
+        block->chunk->num_free--;
+        block->next_free = batch;
+        batch = block;
+      }
+      num_out_ += BATCH_SIZE;
+      peak_out_ = std::max(peak_out_, num_out_);
+      return batch;
+    }
+
+    /**
+     * @brief Puts count blocks linked by next_free back onto the free list
+     */
+    void give(Block* blocks, unsigned int count)
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      for(unsigned int i = 0; i < count; i++)
+      {
+        Block* block = blocks;
+        blocks = block->next_free;
+        block->chunk->num_free++;
+        block->next_free = free_list_;
+        free_list_ = block;
+      }
+      num_out_ -= count;
+    }
+
+    void beginQuery()
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      recent_peaks_.push_back(peak_out_);
+      if(recent_peaks_.size() > history_length_)
+        recent_peaks_.pop_front();
+      peak_out_ = num_out_;
+
+      // keep enough chunks for the largest recent peak
+      const size_t target = std::max(*std::max_element(recent_peaks_.begin(), recent_peaks_.end()), num_out_);
+      const size_t target_chunks = (target + BLOCKS_PER_CHUNK - 1) / BLOCKS_PER_CHUNK;
+      if(chunks_.size() <= target_chunks)
+        return;
+
+      size_t num_released = 0;
+      for(unsigned int i = 0; (i < chunks_.size()) && (chunks_.size() - num_released > target_chunks); i++)
+      {
+        if(chunks_[i]->num_free == BLOCKS_PER_CHUNK)
+        {
+          chunks_[i]->released = true;
+          num_released++;
+        }
+      }
+      if(num_released == 0)
+        return;
+
+      // drop the blocks of the released chunks from the free list before freeing them
+      Block** next = &free_list_;
+      while(*next != NULL)
+      {
+        if((*next)->chunk->released)
+          *next = (*next)->next_free;
+        else
+          next = &(*next)->next_free;
+      }
+
+      std::vector<Chunk*> retained_chunks;
+      retained_chunks.reserve(chunks_.size() - num_released);
+      for(unsigned int i = 0; i < chunks_.size(); i++)
+      {
+        if(chunks_[i]->released)
+          freeChunk(chunks_[i]);
+        else
+          retained_chunks.push_back(chunks_[i]);
+      }
+      chunks_.swap(retained_chunks);
+    }
+
+    size_t getPeakBytes() const
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      return peak_out_ * sizeof(Block);
+    }
+
+    size_t getRetainedBytes() const
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      return chunks_.size() * (BLOCKS_PER_CHUNK * sizeof(Block) + sizeof(Chunk));
+    }
+
+  private:
+    /**
+     * @brief Allocates a chunk and puts its blocks onto the free list (called with the lock held)
+     */
+    void addChunk()
+    {
+      Chunk* chunk = new Chunk();
+      chunk->num_free = BLOCKS_PER_CHUNK;
+      chunk->released = false;
+      chunk->blocks = static_cast<Block*>(malloc(BLOCKS_PER_CHUNK * sizeof(Block)));
+      if(chunk->blocks == NULL)
+      {
+        delete chunk;
+        throw std::bad_alloc();
+      }
+
+      // blocks are handed out in the order of memory
+      for(unsigned int i = BLOCKS_PER_CHUNK; i > 0; i--)
+      {
+        Block* block = new (chunk->blocks + i - 1) Block(chunk);
+        block->next_free = free_list_;
+        free_list_ = block;
+      }
+      chunks_.push_back(chunk);
+    }
+
+    static void freeChunk(Chunk* chunk)
+    {
+      for(unsigned int i = 0; i < BLOCKS_PER_CHUNK; i++)
+      {
+        chunk->blocks[i].~Block();
+      }
+      free(chunk->blocks);
+      delete chunk;
+    }
+
+    mutable boost::mutex mutex_;
+    std::vector<Chunk*> chunks_;
+    Block* free_list_;
+    size_t num_out_, peak_out_; ///< @brief blocks handed to the thread caches (live states or cached)
+    std::deque<size_t> recent_peaks_;
+    unsigned int history_length_;
+  };
+
+
+  /**
+   * @brief Free blocks of one thread, returned to the central free list when the thread exits
+   *        (keeps the central part alive, so threads may outlive the pool)
+   */
+  struct StatePool::ThreadCache
+  {
+    boost::shared_ptr<Central> central;
+    Block* free_list;
+    unsigned int num_free;
+
+    ThreadCache(const boost::shared_ptr<Central>& central_in) : central(central_in), free_list(NULL), num_free(0){}
+
+    ~ThreadCache()
+    {
+      if(num_free > 0)
+        central->give(free_list, num_free);
+    }
+  };
+
+
+  StatePool::StatePool(unsigned int history_length)
+    : central_(new Central(history_length)){}
+
+
+  StatePool::~StatePool()
+  {
+    thread_cache_.reset();
+  }
+
+
+  ompl::base::SE2StateSpace::StateType* StatePool::allocate()
+  {
+    ThreadCache& cache = getThreadCache();
+    if(cache.num_free == 0)
+    {
+      cache.free_list = central_->take();
+      cache.num_free = Central::BATCH_SIZE;
+    }
+
+    Block* block = cache.free_list;
+    cache.free_list = block->next_free;
+    cache.num_free--;
+    return &block->state;
+  }
+
+
+  void StatePool::release(ompl::base::State* state)
+  {
+    if(state == NULL)
+      return;
+
+    ThreadCache& cache = getThreadCache();
+    Block* block = reinterpret_cast<Block*>(state);
+    block->next_free = cache.free_list;
+    cache.free_list = block;
+    cache.num_free++;
+
+    // threads freeing more than they allocate (e.g. the one clearing the planner) hand batches back
+    if(cache.num_free >= 2 * Central::BATCH_SIZE)
+    {
+      Block* batch = cache.free_list;
+      for(unsigned int i = 0; i < Central::BATCH_SIZE; i++)
+      {
+        cache.free_list = cache.free_list->next_free;
+      }
+      cache.num_free -= Central::BATCH_SIZE;
+      central_->give(batch, Central::BATCH_SIZE);
+    }
+  }
+
+
+  void StatePool::beginQuery()
+  {
+    // blocks freed by this thread (which cleared the last query) count as free for the release of chunks
+    ThreadCache& cache = getThreadCache();
+    if(cache.num_free > 0)
+      central_->give(cache.free_list, cache.num_free);
+    cache.free_list = NULL;
+    cache.num_free = 0;
+
+    central_->beginQuery();
+  }
+
+
+  size_t StatePool::getPeakBytes() const
+  {
+    return central_->getPeakBytes();
+  }
+
+
+  size_t StatePool::getRetainedBytes() const
+  {
+    return central_->getRetainedBytes();
+  }
+
+
+  StatePool::ThreadCache& StatePool::getThreadCache()
+  {
+    ThreadCache* cache = thread_cache_.get();
+    if(cache == NULL)
+    {
+      cache = new ThreadCache(central_);
+      thread_cache_.reset(cache);
+    }
+    return *cache;
+  }
+
+
+  PooledSE2StateSpace::PooledSE2StateSpace(const StatePoolPtr& pool)
+    : ompl::base::SE2StateSpace(), pool_(pool){}
+
+
+  ompl::base::State* PooledSE2StateSpace::allocState() const
+  {
+    return pool_->allocate();
+  }
+
+
+  void PooledSE2StateSpace::freeState(ompl::base::State* state) const
+  {
+    pool_->release(state);
+  }
+}
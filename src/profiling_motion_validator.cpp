@@ -0,0 +1,80 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#include <ompl_planner_base/profiling_motion_validator.h>
+
+
+namespace ompl_planner_base {
+
+  ProfilingMotionValidator::ProfilingMotionValidator(ompl::base::SpaceInformation* si, const ompl::base::MotionValidatorPtr& validator,
+                                                     ValidityStatistics* statistics)
+    : ompl::base::MotionValidator(si), validator_(validator), statistics_(statistics), timing_(false), trace_(NULL){}
+
+
+  bool ProfilingMotionValidator::checkMotion(const ompl::base::State* s1, const ompl::base::State* s2) const
+  {
+    statistics_->increment(ValidityStatistics::MOTION_CHECK);
+    if(!timing_ && !trace_)
+      return validator_->checkMotion(s1, s2);
+
+    const boost::uint64_t start_time = ValidityStatistics::now();
+    const bool result = validator_->checkMotion(s1, s2);
+    if(timing_)
+      statistics_->increment(ValidityStatistics::MOTION_CHECK_TIME, ValidityStatistics::now() - start_time);
+    if(trace_)
+      trace_->recordComplete("checkMotion", start_time);
+    return result;
+  }
+
+
+  bool ProfilingMotionValidator::checkMotion(const ompl::base::State* s1, const ompl::base::State* s2,
+                                             std::pair<ompl::base::State*, double>& last_valid) const
+  {
+    statistics_->increment(ValidityStatistics::MOTION_CHECK);
+    if(!timing_ && !trace_)
+      return validator_->checkMotion(s1, s2, last_valid);
+
+    const boost::uint64_t start_time = ValidityStatistics::now();
+    const bool result = validator_->checkMotion(s1, s2, last_valid);
+    if(timing_)
+      statistics_->increment(ValidityStatistics::MOTION_CHECK_TIME, ValidityStatistics::now() - start_time);
+    if(trace_)
+      trace_->recordComplete("checkMotion", start_time);
+    return result;
+  }
+
+}
@@ -0,0 +1,259 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#include <ros/ros.h>
+#include <tf/transform_listener.h>
+#include <tf/transform_datatypes.h>
+#include <costmap_2d/costmap_2d_ros.h>
+#include <nav_msgs/OccupancyGrid.h>
+
+// ros sandbox classes
+#include <ompl_planner_base/ompl_planner_base.h>
+#include <ompl_planner_base/costmap_snapshot.h>
+#include <ompl_planner_base/request_recorder.h>
+
+// ompl planner specific classes
+#include <ompl/util/RandomNumbers.h>
+
+// boost classes
+#include <boost/shared_ptr.hpp>
+
+// std c++ classes
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+/**
+ * @brief Sets the recorded parameters ("type name value" lines) in the namespace of a planner
+ * @return Planner type among the parameters
+ */
+std::string setRecordedParameters(ros::NodeHandle& nh, const std::string& parameters)
+{
+  std::string planner_type;
+  std::istringstream lines(parameters);
+  std::string line;
+  while(std::getline(lines, line))
+  {
+    std::istringstream line_stream(line);
+    std::string type, name;
+    line_stream >> type >> name >> std::ws;
+    if(type == "bool")
+    {
+      std::string value;
+      line_stream >> value;
+      nh.setParam(name, value == "true");
+    }
+    else if(type == "int")
+    {
+      int value = 0;
+      line_stream >> value;
+      nh.setParam(name, value);
+    }
+    else if(type == "double")
+    {
+      double value = 0.0;
+      line_stream >> value;
+      nh.setParam(name, value);
+    }
+    else if(type == "str")
+    {
+      // strings may contain spaces, e.g. portfolios
+      std::string value;
+      std::getline(line_stream, value);
+      nh.setParam(name, value);
+      if(name == "global_planner_type")
+        planner_type = value;
+    }
+  }
+  return planner_type;
+}
+
+
+/**
+ * Replays requests recorded by the plugin (~record_files, separated by semicolons). Every request is planned through
+ * makePlan on its recorded costmap, with the parameters in effect when it was recorded (~planner_type overrides the
+ * recorded planner). The geometry of the costmap configured in ~costmap is taken from the first request, which is
+ * published on "map" for its static layer, and its footprint is set to the recorded one - the remaining layers should
+ * be configured as on the robot so inflation and circumscribed cost match. Requests on a costmap of another geometry are
+ * skipped. One line per request is written to ~output_file.
+ */
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "replay_requests");
+  ros::NodeHandle private_nh("~");
+
+  std::string record_files, output_file, frame_id, planner_type_override;
+  int seed;
+  private_nh.param("record_files", record_files, std::string(""));
+  private_nh.param("output_file", output_file, std::string("replay.csv"));
+  private_nh.param("frame_id", frame_id, std::string("map"));
+  private_nh.param("planner_type", planner_type_override, std::string(""));
+  private_nh.param("seed", seed, 1);
+
+  // seed has to be set before the first random number generator of ompl is created
+  ompl::RNG::setSeed(seed);
+
+  std::vector<std::string> files;
+  std::istringstream file_list(record_files);
+  std::string file;
+  while(std::getline(file_list, file, ';'))
+  {
+    files.push_back(file);
+  }
+
+  ompl_planner_base::RequestReader reader;
+  ompl_planner_base::RecordedRequest request;
+  if(!reader.open(files) || !reader.next(request))
+  {
+    ROS_ERROR("No requests recorded in %s", record_files.c_str());
+    return 1;
+  }
+
+  // costmap gets the geometry of the first request from its static layer
+  nav_msgs::OccupancyGrid map;
+  ompl_planner_base::recordToMap(request, frame_id, map);
+  ros::NodeHandle nh;
+  ros::Publisher map_pub = nh.advertise<nav_msgs::OccupancyGrid>("map", 1, true);
+  map_pub.publish(map);
+  if(!request.footprint.empty())
+    private_nh.setParam("costmap/footprint", ompl_planner_base::formatFootprint(request.footprint));
+
+  ros::AsyncSpinner spinner(1);
+  spinner.start();
+  tf::TransformListener tf(ros::Duration(10));
+  costmap_2d::Costmap2DROS costmap_ros("costmap", tf);
+
+  const ros::WallTime wait_start_time = ros::WallTime::now();
+  while( ros::ok() && ((costmap_ros.getCostmap()->getSizeInCellsX() != map.info.width) ||
+                       (costmap_ros.getCostmap()->getSizeInCellsY() != map.info.height)) )
+  {
+    if((ros::WallTime::now() - wait_start_time).toSec() > 10.0)
+    {
+      ROS_ERROR("Costmap did not receive the map - is a static layer subscribed to \"map\" configured in ~costmap?");
+      return 1;
+    }
+    ros::WallDuration(0.1).sleep();
+  }
+
+  std::ofstream output(output_file.c_str());
+  if(!output)
+  {
+    ROS_ERROR("Could not open %s to write the results", output_file.c_str());
+    return 1;
+  }
+  output.precision(9);
+  output << "sequence,stamp,planner,success,solve_time,simplification_time,total_time,path_length,validity_checks,motion_checks\n";
+
+  // planner is recreated whenever the recorded parameters change
+  boost::shared_ptr<ompl_planner_base::OMPLPlannerBase> planner;
+  std::string planner_parameters, planner_type;
+  const ompl_planner_base::RecordedRequest first_request = request;
+  unsigned int num_replayed = 0, num_solved = 0, num_skipped = 0;
+  do
+  {
+    if( (request.size_x != first_request.size_x) || (request.size_y != first_request.size_y) ||
+        (request.resolution != first_request.resolution) || (request.origin_x != first_request.origin_x) ||
+        (request.origin_y != first_request.origin_y) )
+    {
+      num_skipped++;
+      continue;
+    }
+
+    if(!planner || (request.parameters != planner_parameters))
+    {
+      std::ostringstream name;
+      name << "planner_" << num_replayed;
+      ros::NodeHandle planner_nh(private_nh, name.str());
+      planner_type = setRecordedParameters(planner_nh, request.parameters);
+      if(!planner_type_override.empty())
+      {
+        planner_nh.setParam("global_planner_type", planner_type_override);
+        planner_type = planner_type_override;
+      }
+      planner_nh.setParam("publish_diagnostics", true);
+
+      planner.reset();
+      planner = boost::shared_ptr<ompl_planner_base::OMPLPlannerBase>(
+        new ompl_planner_base::OMPLPlannerBase(name.str(), &costmap_ros));
+      planner_parameters = request.parameters;
+    }
+
+    // planner keeps the snapshot until the next one is set -> every request gets its own
+    ompl_planner_base::CostmapSnapshotPtr snapshot(new ompl_planner_base::CostmapSnapshot());
+    snapshot->copy(request.getView());
+    planner->setCostmapSnapshot(snapshot);
+
+    geometry_msgs::PoseStamped start, goal;
+    start.header.frame_id = costmap_ros.getGlobalFrameID();
+    start.pose.position.x = request.start.x;
+    start.pose.position.y = request.start.y;
+    start.pose.orientation = tf::createQuaternionMsgFromYaw(request.start.theta);
+    goal.header.frame_id = costmap_ros.getGlobalFrameID();
+    goal.pose.position.x = request.goal.x;
+    goal.pose.position.y = request.goal.y;
+    goal.pose.orientation = tf::createQuaternionMsgFromYaw(request.goal.theta);
+
+    std::vector<geometry_msgs::PoseStamped> plan;
+    const ros::WallTime start_time = ros::WallTime::now();
+    const bool success = planner->makePlan(start, goal, plan);
+    const double total_time = (ros::WallTime::now() - start_time).toSec();
+
+    // queries rejected before planning publish no diagnostics
+    const ompl_planner_base::OMPLPlannerDiagnostics::ConstPtr diagnostics = planner->getLastDiagnostics();
+    const ompl_planner_base::OMPLPlannerBaseStats::ConstPtr statistics = planner->getLastStatistics();
+    output << request.sequence << "," << request.stamp << "," << planner_type << "," << (success ? 1 : 0) << ","
+           << (diagnostics ? diagnostics->planning_time : 0.0) << "," << (diagnostics ? diagnostics->simplification_time : 0.0) << ","
+           << total_time << "," << ((success && statistics) ? statistics->path_length : 0.0) << ","
+           << (diagnostics ? diagnostics->validity_check_count : 0) << "," << (diagnostics ? diagnostics->motion_check_count : 0) << "\n";
+
+    num_replayed++;
+    if(success)
+      num_solved++;
+  }
+  while(ros::ok() && reader.next(request));
+
+  if(num_skipped > 0)
+    ROS_WARN("Skipped %d recorded requests on a costmap of another geometry than the first one", num_skipped);
+  ROS_INFO("Replayed %d requests, %d solved", num_replayed, num_solved);
+
+  // planner uses the costmap until it is destroyed
+  planner.reset();
+  spinner.stop();
+  return 0;
+}
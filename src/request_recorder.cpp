@@ -0,0 +1,650 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#include <ompl_planner_base/request_recorder.h>
+#include <ros/ros.h>
+#include <tf/transform_datatypes.h>
+#include <costmap_2d/cost_values.h>
+
+// boost classes
+#include <boost/bind.hpp>
+#include <boost/interprocess/exceptions.hpp>
+
+// std c++ classes
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+
+namespace ompl_planner_base {
+
+  static const char FILE_MAGIC[8] = {'O', 'M', 'P', 'L', 'R', 'E', 'Q', '\0'};
+  static const boost::uint32_t FILE_VERSION = 1;
+  static const boost::uint32_t RECORD_MAGIC = 0x5145524f; // "OREQ"
+  static const boost::uint32_t FULL_ENCODING = 0;
+  static const boost::uint32_t DELTA_ENCODING = 1; // cells are xor-ed with the previous record
+
+  /**
+     * @brief Start of every record file, end is updated after each record so the file stays readable after a crash
+     */
+  struct FileHeader
+  {
+    char magic[8];
+    boost::uint32_t version;
+    boost::uint32_t header_size;
+    boost::uint64_t first_sequence, last_sequence;
+    boost::uint64_t end; ///< @brief offset behind the last complete record
+  };
+
+  /**
+     * @brief Fixed part of a record, followed by the footprint (x, y), the parameters and the encoded costs
+     */
+  struct RecordHeader
+  {
+    boost::uint32_t magic;
+    boost::uint32_t size; ///< @brief size of the record including this header, multiple of 8
+    boost::uint64_t sequence;
+    double stamp;
+    double start[3], goal[3];
+    double resolution, origin_x, origin_y;
+    boost::uint32_t size_x, size_y;
+    boost::uint32_t num_footprint_points, parameters_size;
+    boost::uint32_t encoding, costs_size;
+  };
+
+
+  /**
+     * @brief Run-length encoding, every run is stored as value followed by its length (7 bit groups, lowest first)
+     */
+  static void encodeRuns(const unsigned char* cells, size_t num_cells, std::vector<unsigned char>& encoded)
+  {
+    encoded.clear();
+    size_t i = 0;
+    while(i < num_cells)
+    {
+      const unsigned char value = cells[i];
+      size_t end = i + 1;
+      while( (end < num_cells) && (cells[end] == value) )
+        end++;
+
+      encoded.push_back(value);
+      size_t length = end - i;
+      while(length >= 0x80)
+      {
+        encoded.push_back((unsigned char) ((length & 0x7f) | 0x80));
+        length >>= 7;
+      }
+      encoded.push_back((unsigned char) length);
+      i = end;
+    }
+  }
+
+
+  /**
+     * @brief Decodes runs into the cells (xor-ed onto them for a delta)
+     * @return false if the runs do not cover exactly all cells
+     */
+  static bool decodeRuns(const unsigned char* encoded, size_t encoded_size, unsigned char* cells, size_t num_cells, bool delta)
+  {
+    size_t position = 0, cell = 0;
+    while(position < encoded_size)
+    {
+      const unsigned char value = encoded[position++];
+      size_t length = 0;
+      unsigned int shift = 0;
+      while(true)
+      {
+        if( (position >= encoded_size) || (shift > 56) )
+          return false;
+        const unsigned char byte = encoded[position++];
+        length |= (size_t) (byte & 0x7f) << shift;
+        shift += 7;
+        if(!(byte & 0x80))
+          break;
+      }
+      if(length > num_cells - cell)
+        return false;
+
+      if(!delta)
+      {
+        memset(cells + cell, value, length);
+      }
+      else if(value != 0)
+      {
+        for(size_t i = cell; i < cell + length; i++)
+        {
+          cells[i] ^= value;
+        }
+      }
+      cell += length;
+    }
+    return cell == num_cells;
+  }
+
+
+  static std::string getFileName(const std::string& directory, unsigned int index)
+  {
+    std::ostringstream name;
+    name << directory << "/requests_" << index << ".rec";
+    return name.str();
+  }
+
+
+  /**
+     * @brief Reads the header of a record file
+     * @return false if the file does not exist or is no record file
+     */
+  static bool readFileHeader(const std::string& file_name, FileHeader& header)
+  {
+    std::ifstream file(file_name.c_str(), std::ios::binary);
+    if(!file || !file.read((char*) &header, sizeof(header)))
+      return false;
+    return (memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0) && (header.version == FILE_VERSION) &&
+           (header.header_size == sizeof(FileHeader));
+  }
+
+
+  RequestRecorder::RequestRecorder()
+    : file_size_(0), num_files_(0), file_index_(0), previous_size_x_(0), previous_size_y_(0), previous_resolution_(0.0),
+      previous_origin_x_(0.0), previous_origin_y_(0.0), has_previous_(false), pending_(false), shutdown_(false),
+      next_sequence_(0), num_recorded_(0), num_dropped_(0), writer_thread_(NULL){}
+
+
+  RequestRecorder::~RequestRecorder()
+  {
+    close();
+  }
+
+
+  bool RequestRecorder::open(const std::string& directory, size_t file_size, unsigned int num_files)
+  {
+    close();
+    directory_ = directory;
+    file_size_ = std::max(file_size, sizeof(FileHeader) + sizeof(RecordHeader));
+    num_files_ = std::max(num_files, 1u);
+
+    // continue behind the newest record of an earlier run -> records before a restart are kept as long as possible
+    unsigned int newest_index = num_files_ - 1;
+    boost::uint64_t first_sequence = 0;
+    for(unsigned int i = 0; i < num_files_; i++)
+    {
+      FileHeader header;
+      if( readFileHeader(getFileName(directory_, i), header) && (header.end > sizeof(FileHeader)) &&
+          (header.last_sequence + 1 > first_sequence) )
+      {
+        newest_index = i;
+        first_sequence = header.last_sequence + 1;
+      }
+    }
+
+    if(!startFile((newest_index + 1) % num_files_, first_sequence))
+      return false;
+
+    boost::mutex::scoped_lock lock(mutex_);
+    pending_ = false;
+    shutdown_ = false;
+    next_sequence_ = first_sequence;
+    num_recorded_ = 0;
+    num_dropped_ = 0;
+    writer_thread_ = new boost::thread(boost::bind(&RequestRecorder::runWriter, this));
+    return true;
+  }
+
+
+  void RequestRecorder::close()
+  {
+    if(!writer_thread_)
+      return;
+
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      shutdown_ = true;
+      pending_cond_.notify_all();
+    }
+    writer_thread_->join();
+    delete writer_thread_;
+    writer_thread_ = NULL;
+
+    if(region_)
+      region_->flush();
+    region_.reset();
+    ROS_INFO("Recorded %lu requests to %s (%lu dropped)", num_recorded_, directory_.c_str(), num_dropped_);
+  }
+
+
+  bool RequestRecorder::record(const RecordedRequest& request, const CostmapView& costmap)
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    if(!writer_thread_ || shutdown_)
+      return false;
+
+    if(pending_)
+    {
+      num_dropped_++;
+      return false;
+    }
+
+    // buffers of the pending request keep their capacity -> no allocation once the costmap size is stable
+    pending_request_ = request;
+    pending_request_.sequence = next_sequence_++;
+    pending_request_.size_x = costmap.getSizeInCellsX();
+    pending_request_.size_y = costmap.getSizeInCellsY();
+    pending_request_.resolution = costmap.getResolution();
+    pending_request_.origin_x = costmap.getOriginX();
+    pending_request_.origin_y = costmap.getOriginY();
+    const size_t num_cells = (size_t) pending_request_.size_x * pending_request_.size_y;
+    pending_request_.costs.assign(costmap.getCharMap(), costmap.getCharMap() + num_cells);
+
+    pending_ = true;
+    pending_cond_.notify_one();
+    return true;
+  }
+
+
+  unsigned long RequestRecorder::getNumRecorded() const
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    return num_recorded_;
+  }
+
+
+  unsigned long RequestRecorder::getNumDropped() const
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    return num_dropped_;
+  }
+
+
+  void RequestRecorder::runWriter()
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    while(true)
+    {
+      while(!pending_ && !shutdown_)
+      {
+        pending_cond_.wait(lock);
+      }
+      if(!pending_)
+        return;
+
+      // pending request is not touched by record() until pending_ is reset
+      lock.unlock();
+      const bool written = write(pending_request_);
+      lock.lock();
+
+      pending_ = false;
+      if(written)
+        num_recorded_++;
+      else
+        num_dropped_++;
+    }
+  }
+
+
+  bool RequestRecorder::write(RecordedRequest& request)
+  {
+    // mapping of the current file failed -> try the next one
+    if(!region_ && !startFile((file_index_ + 1) % num_files_, request.sequence))
+      return false;
+
+    const size_t num_cells = request.costs.size();
+    bool delta = has_previous_ && (previous_costs_.size() == num_cells) && (previous_size_x_ == request.size_x) &&
+                 (previous_resolution_ == request.resolution) && (previous_origin_x_ == request.origin_x) &&
+                 (previous_origin_y_ == request.origin_y);
+    if(delta)
+    {
+      delta_.resize(num_cells);
+      for(size_t i = 0; i < num_cells; i++)
+      {
+        delta_[i] = request.costs[i] ^ previous_costs_[i];
+      }
+      encodeRuns(delta_.empty() ? NULL : &delta_[0], num_cells, encoded_);
+    }
+    else
+    {
+      encodeRuns(request.costs.empty() ? NULL : &request.costs[0], num_cells, encoded_);
+    }
+
+    size_t size = sizeof(RecordHeader) + request.footprint.size() * 2 * sizeof(double) + request.parameters.size();
+    FileHeader* file_header = static_cast<FileHeader*>(region_->get_address());
+    if(file_header->end + size + encoded_.size() + 7 > file_size_)
+    {
+      // first record of a file is complete
+      if(delta)
+      {
+        delta = false;
+        encodeRuns(request.costs.empty() ? NULL : &request.costs[0], num_cells, encoded_);
+      }
+      if(sizeof(FileHeader) + size + encoded_.size() + 7 > file_size_)
+      {
+        ROS_WARN_ONCE("Request of %lu bytes does not fit into a record file of %lu bytes - such requests are not recorded",
+                      (unsigned long) (size + encoded_.size()), (unsigned long) file_size_);
+        return false;
+      }
+      if(!startFile((file_index_ + 1) % num_files_, request.sequence))
+        return false;
+      file_header = static_cast<FileHeader*>(region_->get_address());
+    }
+    size = (size + encoded_.size() + 7) & ~((size_t) 7);
+
+    RecordHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = RECORD_MAGIC;
+    header.size = (boost::uint32_t) size;
+    header.sequence = request.sequence;
+    header.stamp = request.stamp;
+    header.start[0] = request.start.x;
+    header.start[1] = request.start.y;
+    header.start[2] = request.start.theta;
+    header.goal[0] = request.goal.x;
+    header.goal[1] = request.goal.y;
+    header.goal[2] = request.goal.theta;
+    header.resolution = request.resolution;
+    header.origin_x = request.origin_x;
+    header.origin_y = request.origin_y;
+    header.size_x = request.size_x;
+    header.size_y = request.size_y;
+    header.num_footprint_points = request.footprint.size();
+    header.parameters_size = request.parameters.size();
+    header.encoding = delta ? DELTA_ENCODING : FULL_ENCODING;
+    header.costs_size = encoded_.size();
+
+    unsigned char* data = static_cast<unsigned char*>(region_->get_address()) + file_header->end;
+    memcpy(data, &header, sizeof(header));
+    data += sizeof(header);
+    for(unsigned int i = 0; i < request.footprint.size(); i++)
+    {
+      const double point[2] = {request.footprint[i].x, request.footprint[i].y};
+      memcpy(data, point, sizeof(point));
+      data += sizeof(point);
+    }
+    memcpy(data, request.parameters.data(), request.parameters.size());
+    data += request.parameters.size();
+    if(!encoded_.empty())
+      memcpy(data, &encoded_[0], encoded_.size());
+
+    // record is only visible to readers once the end is moved behind it
+    file_header->last_sequence = request.sequence;
+    file_header->end += size;
+
+    // costs are the base of the next delta (pending buffer takes over the old base as storage for the next copy)
+    previous_costs_.swap(request.costs);
+    previous_size_x_ = request.size_x;
+    previous_size_y_ = request.size_y;
+    previous_resolution_ = request.resolution;
+    previous_origin_x_ = request.origin_x;
+    previous_origin_y_ = request.origin_y;
+    has_previous_ = true;
+    return true;
+  }
+
+
+  bool RequestRecorder::startFile(unsigned int index, boost::uint64_t first_sequence)
+  {
+    if(region_)
+      region_->flush();
+    region_.reset();
+    has_previous_ = false;
+
+    const std::string file_name = getFileName(directory_, index);
+    {
+      // file has to have its final size before it is mapped
+      std::filebuf file;
+      if(!file.open(file_name.c_str(), std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary))
+      {
+        ROS_ERROR("Could not create record file %s", file_name.c_str());
+        return false;
+      }
+      file.pubseekoff(file_size_ - 1, std::ios::beg);
+      file.sputc(0);
+    }
+
+    try
+    {
+      boost::interprocess::file_mapping mapping(file_name.c_str(), boost::interprocess::read_write);
+      region_.reset(new boost::interprocess::mapped_region(mapping, boost::interprocess::read_write));
+    }
+    catch(const boost::interprocess::interprocess_exception& e)
+    {
+      ROS_ERROR("Could not map record file %s: %s", file_name.c_str(), e.what());
+      region_.reset();
+      return false;
+    }
+
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.version = FILE_VERSION;
+    header.header_size = sizeof(FileHeader);
+    header.first_sequence = first_sequence;
+    header.last_sequence = first_sequence;
+    header.end = sizeof(FileHeader);
+    memcpy(region_->get_address(), &header, sizeof(header));
+
+    file_index_ = index;
+    return true;
+  }
+
+
+  RequestReader::RequestReader()
+    : file_index_(0), offset_(0), end_(0){}
+
+
+  bool RequestReader::open(const std::vector<std::string>& files)
+  {
+    region_.reset();
+    mapping_.reset();
+    files_.clear();
+    file_index_ = 0;
+    offset_ = 0;
+    end_ = 0;
+
+    // files of a ring are read from the oldest to the newest
+    std::vector<std::pair<boost::uint64_t, std::string> > sorted_files;
+    for(unsigned int i = 0; i < files.size(); i++)
+    {
+      FileHeader header;
+      if(!readFileHeader(files[i], header))
+      {
+        ROS_ERROR("%s is no record file", files[i].c_str());
+        return false;
+      }
+      if(header.end > sizeof(FileHeader))
+        sorted_files.push_back(std::make_pair(header.first_sequence, files[i]));
+    }
+    std::sort(sorted_files.begin(), sorted_files.end());
+
+    for(unsigned int i = 0; i < sorted_files.size(); i++)
+    {
+      files_.push_back(sorted_files[i].second);
+    }
+    return true;
+  }
+
+
+  bool RequestReader::openFile(unsigned int index)
+  {
+    region_.reset();
+    mapping_.reset();
+    previous_costs_.clear();
+    try
+    {
+      mapping_.reset(new boost::interprocess::file_mapping(files_[index].c_str(), boost::interprocess::read_only));
+      region_.reset(new boost::interprocess::mapped_region(*mapping_, boost::interprocess::read_only));
+    }
+    catch(const boost::interprocess::interprocess_exception& e)
+    {
+      ROS_ERROR("Could not map record file %s: %s", files_[index].c_str(), e.what());
+      region_.reset();
+      mapping_.reset();
+      return false;
+    }
+
+    FileHeader header;
+    memcpy(&header, region_->get_address(), sizeof(header));
+    offset_ = sizeof(FileHeader);
+    end_ = std::min((size_t) header.end, region_->get_size());
+    return true;
+  }
+
+
+  bool RequestReader::next(RecordedRequest& request)
+  {
+    while(true)
+    {
+      if(!region_ || (offset_ >= end_))
+      {
+        if(region_)
+          file_index_++;
+        if(file_index_ >= files_.size())
+        {
+          region_.reset();
+          mapping_.reset();
+          return false;
+        }
+        if(!openFile(file_index_))
+        {
+          file_index_++;
+          continue;
+        }
+      }
+
+      const unsigned char* data = static_cast<const unsigned char*>(region_->get_address()) + offset_;
+      RecordHeader header;
+      if(offset_ + sizeof(header) <= end_)
+        memcpy(&header, data, sizeof(header));
+      if( (offset_ + sizeof(header) > end_) || (header.magic != RECORD_MAGIC) || (header.size < sizeof(header)) ||
+          (offset_ + header.size > end_) ||
+          (sizeof(header) + header.num_footprint_points * 2 * sizeof(double) + header.parameters_size + header.costs_size > header.size) )
+      {
+        ROS_ERROR("Corrupt record at offset %lu of %s - skipping the rest of the file", (unsigned long) offset_,
+                  files_[file_index_].c_str());
+        offset_ = end_;
+        continue;
+      }
+      offset_ += header.size;
+
+      request.sequence = header.sequence;
+      request.stamp = header.stamp;
+      request.start.x = header.start[0];
+      request.start.y = header.start[1];
+      request.start.theta = header.start[2];
+      request.goal.x = header.goal[0];
+      request.goal.y = header.goal[1];
+      request.goal.theta = header.goal[2];
+      request.resolution = header.resolution;
+      request.origin_x = header.origin_x;
+      request.origin_y = header.origin_y;
+      request.size_x = header.size_x;
+      request.size_y = header.size_y;
+
+      data += sizeof(header);
+      request.footprint.resize(header.num_footprint_points);
+      for(unsigned int i = 0; i < header.num_footprint_points; i++)
+      {
+        double point[2];
+        memcpy(point, data, sizeof(point));
+        data += sizeof(point);
+        request.footprint[i].x = point[0];
+        request.footprint[i].y = point[1];
+        request.footprint[i].z = 0.0;
+      }
+      request.parameters.assign((const char*) data, header.parameters_size);
+      data += header.parameters_size;
+
+      const size_t num_cells = (size_t) header.size_x * header.size_y;
+      const bool delta = (header.encoding == DELTA_ENCODING);
+      if(delta && (previous_costs_.size() != num_cells))
+      {
+        ROS_ERROR("Record %lu is a delta without a matching previous record - skipped", (unsigned long) header.sequence);
+        continue;
+      }
+      if(delta)
+        request.costs = previous_costs_;
+      else
+        request.costs.resize(num_cells);
+
+      if(!decodeRuns(data, header.costs_size, request.costs.empty() ? NULL : &request.costs[0], num_cells, delta))
+      {
+        ROS_ERROR("Costs of record %lu are corrupt - skipped", (unsigned long) header.sequence);
+        previous_costs_.clear();
+        continue;
+      }
+      previous_costs_ = request.costs;
+      return true;
+    }
+  }
+
+
+
+  void recordToMap(const RecordedRequest& request, const std::string& frame_id, nav_msgs::OccupancyGrid& map)
+  {
+    map.header.frame_id = frame_id;
+    map.header.stamp = ros::Time::now();
+    map.info.map_load_time = map.header.stamp;
+    map.info.resolution = request.resolution;
+    map.info.width = request.size_x;
+    map.info.height = request.size_y;
+    map.info.origin.position.x = request.origin_x;
+    map.info.origin.position.y = request.origin_y;
+    map.info.origin.orientation = tf::createQuaternionMsgFromYaw(0.0);
+
+    map.data.resize(request.costs.size());
+    for(unsigned int i = 0; i < request.costs.size(); i++)
+    {
+      const unsigned char cost = request.costs[i];
+      map.data[i] = (cost == costmap_2d::NO_INFORMATION) ? -1 : ((cost >= costmap_2d::INSCRIBED_INFLATED_OBSTACLE) ? 100 : 0);
+    }
+  }
+
+
+  std::string formatFootprint(const std::vector<geometry_msgs::Point>& footprint)
+  {
+    std::ostringstream stream;
+    stream.precision(9);
+    stream << "[";
+    for(unsigned int i = 0; i < footprint.size(); i++)
+    {
+      stream << (i > 0 ? ", " : "") << "[" << footprint[i].x << ", " << footprint[i].y << "]";
+    }
+    stream << "]";
+    return stream.str();
+  }
+
+}
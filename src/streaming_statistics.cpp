@@ -0,0 +1,149 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#include <ompl_planner_base/streaming_statistics.h>
+
+// std c++ classes
+#include <algorithm>
+#include <limits>
+#include <math.h>
+
+
+namespace ompl_planner_base {
+
+  void RunningStatistics::reset()
+  {
+    count_ = 0;
+    mean_ = 0.0;
+    m2_ = 0.0;
+    min_ = 0.0;
+    max_ = 0.0;
+  }
+
+
+  void RunningStatistics::add(double value)
+  {
+    count_++;
+    if(count_ == 1)
+    {
+      min_ = value;
+      max_ = value;
+    }
+    else
+    {
+      min_ = std::min(min_, value);
+      max_ = std::max(max_, value);
+    }
+
+    const double delta = value - mean_;
+    mean_ += delta / count_;
+    m2_ += delta * (value - mean_);
+  }
+
+
+  double RunningStatistics::getVariance() const
+  {
+    return (count_ > 1) ? m2_ / (count_ - 1) : 0.0;
+  }
+
+
+  double RunningStatistics::getStdDev() const
+  {
+    return sqrt(getVariance());
+  }
+
+
+  QuantileHistogram::QuantileHistogram(double min_value, double max_value, double relative_error)
+    : min_value_(min_value)
+  {
+    gamma_ = (1.0 + relative_error) / (1.0 - relative_error);
+    inv_log_gamma_ = 1.0 / log(gamma_);
+
+    // one bucket for the samples up to min_value, one for each factor gamma up to max_value
+    const unsigned int num_buckets = (unsigned int) ceil(log(max_value / min_value) * inv_log_gamma_) + 1;
+    buckets_.resize(std::max(num_buckets, 2u));
+    reset();
+  }
+
+
+  void QuantileHistogram::reset()
+  {
+    std::fill(buckets_.begin(), buckets_.end(), 0ul);
+    count_ = 0;
+    min_ = std::numeric_limits<double>::max();
+    max_ = -std::numeric_limits<double>::max();
+  }
+
+
+  void QuantileHistogram::add(double value)
+  {
+    unsigned int index = 0;
+    if(value > min_value_)
+    {
+      const double bucket = ceil(log(value / min_value_) * inv_log_gamma_);
+      index = (bucket < buckets_.size() - 1) ? (unsigned int) bucket : buckets_.size() - 1;
+    }
+
+    buckets_[index]++;
+    count_++;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+  }
+
+
+  double QuantileHistogram::getQuantile(double q) const
+  {
+    if(count_ == 0)
+      return 0.0;
+
+    // rank of the sample the quantile refers to (1 -> smallest)
+    const double rank = std::max(1.0, ceil(std::min(std::max(q, 0.0), 1.0) * count_));
+    unsigned long cumulated = 0;
+    unsigned int index = 0;
+    for(; index < buckets_.size() - 1; index++)
+    {
+      cumulated += buckets_[index];
+      if(cumulated >= rank)
+        break;
+    }
+
+    // center of the bucket with respect to the relative error, never outside the samples seen
+    const double estimate = min_value_ * 2.0 * pow(gamma_, (double) index) / (gamma_ + 1.0);
+    return std::min(std::max(estimate, min_), max_);
+  }
+
+}
@@ -0,0 +1,335 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#include <ompl_planner_base/swept_footprint_motion_validator.h>
+#include <ompl/base/spaces/SE2StateSpace.h>
+#include <costmap_2d/cost_values.h>
+#include <angles/angles.h>
+
+// std c++ classes
+#include <math.h>
+#include <algorithm>
+
+
+namespace ompl_planner_base {
+
+  // maximum number of cells of the bounding box of a motion, longer motions are split in halves
+  // (motions shorter than a cell are checked with a larger mask, the mask of a large footprint never gets this small)
+  static const unsigned int MAX_MASK_CELLS = 256 * 256;
+
+
+  SweptFootprintMotionValidator::SweptFootprintMotionValidator(ompl::base::SpaceInformation* si)
+    : ompl::base::MotionValidator(si), circumscribed_radius_(0.0), max_cost_(costmap_2d::LETHAL_OBSTACLE){}
+
+
+  void SweptFootprintMotionValidator::setCostmap(const CostmapView& costmap, const std::vector<geometry_msgs::Point>& footprint,
+                                                 int max_cost)
+  {
+    costmap_ = costmap;
+    footprint_ = footprint;
+    max_cost_ = max_cost;
+
+    circumscribed_radius_ = 0.0;
+    for(unsigned int i = 0; i < footprint_.size(); i++)
+    {
+      circumscribed_radius_ = std::max(circumscribed_radius_, sqrt(footprint_[i].x*footprint_[i].x + footprint_[i].y*footprint_[i].y));
+    }
+  }
+
+
+  SweptFootprintMotionValidator::Scratch& SweptFootprintMotionValidator::getScratch() const
+  {
+    if(!scratch_.get())
+      scratch_.reset(new Scratch());
+    return *scratch_;
+  }
+
+
+  void SweptFootprintMotionValidator::addFootprintCorners(const ompl::base::State* state, Scratch& scratch) const
+  {
+    const ompl::base::SE2StateSpace::StateType* se2_state = state->as<ompl::base::SE2StateSpace::StateType>();
+    const double cos_th = cos(se2_state->getYaw());
+    const double sin_th = sin(se2_state->getYaw());
+    const double resolution = costmap_.getResolution();
+
+    for(unsigned int i = 0; i < footprint_.size(); i++)
+    {
+      const double wx = se2_state->getX() + (footprint_[i].x * cos_th - footprint_[i].y * sin_th);
+      const double wy = se2_state->getY() + (footprint_[i].x * sin_th + footprint_[i].y * cos_th);
+      scratch.corners.push_back(std::make_pair((wx - costmap_.getOriginX()) / resolution, (wy - costmap_.getOriginY()) / resolution));
+    }
+  }
+
+
+  // z-component of the cross product of (a - o) and (b - o), positive for a counter-clockwise turn
+  static inline double cross(const std::pair<double, double>& o, const std::pair<double, double>& a, const std::pair<double, double>& b)
+  {
+    return (a.first - o.first) * (b.second - o.second) - (a.second - o.second) * (b.first - o.first);
+  }
+
+
+  void SweptFootprintMotionValidator::computeConvexHull(Scratch& scratch) const
+  {
+    // monotone chain on the corners sorted by x (then y)
+    scratch.points = scratch.corners;
+    std::sort(scratch.points.begin(), scratch.points.end());
+    const std::vector<std::pair<double, double> >& points = scratch.points;
+    const int num_points = (int) points.size();
+
+    std::vector<std::pair<double, double> >& hull = scratch.hull;
+    hull.resize(2 * num_points);
+    int k = 0;
+
+    // lower hull
+    for(int i = 0; i < num_points; i++)
+    {
+      while( (k >= 2) && (cross(hull[k-2], hull[k-1], points[i]) <= 0.0) )
+        k--;
+      hull[k++] = points[i];
+    }
+
+    // upper hull
+    for(int i = num_points - 2, lower_size = k + 1; i >= 0; i--)
+    {
+      while( (k >= lower_size) && (cross(hull[k-2], hull[k-1], points[i]) <= 0.0) )
+        k--;
+      hull[k++] = points[i];
+    }
+
+    // last point equals the first one
+    hull.resize(std::max(k - 1, 0));
+  }
+
+
+  bool SweptFootprintMotionValidator::checkHullCells(Scratch& scratch, int mask_min_x, int mask_min_y, int mask_size_x) const
+  {
+    const std::vector<std::pair<double, double> >& hull = scratch.hull;
+    const unsigned int num_hull = hull.size();
+    if(num_hull == 0)
+      return true;
+
+    double min_y = hull[0].second, max_y = hull[0].second;
+    for(unsigned int i = 1; i < num_hull; i++)
+    {
+      min_y = std::min(min_y, hull[i].second);
+      max_y = std::max(max_y, hull[i].second);
+    }
+    const int first_row = (int) floor(min_y);
+    const int last_row = (int) floor(max_y);
+
+    const unsigned char* cells = costmap_.getCharMap();
+    const int size_x = (int) costmap_.getSizeInCellsX();
+    const int size_y = (int) costmap_.getSizeInCellsY();
+
+    for(int row = first_row; row <= last_row; row++)
+    {
+      // extension of the hull within the band of the row -> clip all edges to the band
+      const double band_low = std::max((double) row, min_y);
+      const double band_high = std::min((double) (row + 1), max_y);
+      double row_min_x = 0.0, row_max_x = 0.0;
+      bool row_covered = false;
+      for(unsigned int i = 0; i < num_hull; i++)
+      {
+        const unsigned int j = (i + 1) % num_hull;
+        double x0 = hull[i].first, y0 = hull[i].second;
+        double x1 = hull[j].first, y1 = hull[j].second;
+        if(y0 > y1)
+        {
+          std::swap(x0, x1);
+          std::swap(y0, y1);
+        }
+        if( (y1 < band_low) || (y0 > band_high) )
+          continue;
+
+        double xa = x0, xb = x1;
+        if(y1 > y0)
+        {
+          const double slope = (x1 - x0) / (y1 - y0);
+          xa = x0 + slope * (std::max(y0, band_low) - y0);
+          xb = x0 + slope * (std::min(y1, band_high) - y0);
+        }
+        if(!row_covered)
+        {
+          row_min_x = std::min(xa, xb);
+          row_max_x = std::max(xa, xb);
+          row_covered = true;
+        }
+        else
+        {
+          row_min_x = std::min(row_min_x, std::min(xa, xb));
+          row_max_x = std::max(row_max_x, std::max(xa, xb));
+        }
+      }
+      if(!row_covered)
+        continue;
+
+      const int first_col = (int) floor(row_min_x);
+      const int last_col = (int) floor(row_max_x);
+
+      // swept area leaves the map
+      if( (row < 0) || (row >= size_y) || (first_col < 0) || (last_col >= size_x) )
+        return false;
+
+      unsigned char* mask_row = &scratch.mask[(row - mask_min_y) * mask_size_x];
+      const unsigned char* cell_row = &cells[row * size_x];
+      for(int col = first_col; col <= last_col; col++)
+      {
+        if(mask_row[col - mask_min_x])
+          continue;
+        mask_row[col - mask_min_x] = 1;
+
+        const unsigned char cost = cell_row[col];
+        if( (cost == costmap_2d::LETHAL_OBSTACLE) || (cost == costmap_2d::NO_INFORMATION) || (cost >= max_cost_) )
+          return false;
+      }
+    }
+
+    return true;
+  }
+
+
+  double SweptFootprintMotionValidator::checkSweptArea(const ompl::base::State* s1, const ompl::base::State* s2) const
+  {
+    const ompl::base::SE2StateSpace::StateType* from = s1->as<ompl::base::SE2StateSpace::StateType>();
+    const ompl::base::SE2StateSpace::StateType* to = s2->as<ompl::base::SE2StateSpace::StateType>();
+    const double resolution = costmap_.getResolution();
+
+    // bounding box of the motion in cells (the footprint stays within the circumscribed radius around the center)
+    const double margin = circumscribed_radius_ / resolution + 1.0;
+    const double from_x = (from->getX() - costmap_.getOriginX()) / resolution;
+    const double from_y = (from->getY() - costmap_.getOriginY()) / resolution;
+    const double to_x = (to->getX() - costmap_.getOriginX()) / resolution;
+    const double to_y = (to->getY() - costmap_.getOriginY()) / resolution;
+    const int mask_min_x = (int) floor(std::min(from_x, to_x) - margin);
+    const int mask_min_y = (int) floor(std::min(from_y, to_y) - margin);
+    const int mask_size_x = (int) ceil(std::max(from_x, to_x) + margin) - mask_min_x + 1;
+    const int mask_size_y = (int) ceil(std::max(from_y, to_y) + margin) - mask_min_y + 1;
+
+    const ompl::base::StateSpacePtr& space = si_->getStateSpace();
+
+    // too long to be covered by one mask -> check both halves of the motion
+    const bool longer_than_cell = (fabs(to_x - from_x) > 1.0) || (fabs(to_y - from_y) > 1.0);
+    if(longer_than_cell && ((unsigned int) (mask_size_x * mask_size_y) > MAX_MASK_CELLS))
+    {
+      ompl::base::State* middle = si_->allocState();
+      space->interpolate(s1, s2, 0.5, middle);
+      double fraction = 0.5 * checkSweptArea(s1, middle);
+      if(fraction == 0.5)
+        fraction += 0.5 * checkSweptArea(middle, s2);
+      si_->freeState(middle);
+      return fraction;
+    }
+
+    Scratch& scratch = getScratch();
+    scratch.mask.assign(mask_size_x * mask_size_y, 0);
+
+    // bound rotation per sub-step such that the chords of the corner arcs deviate less than half a cell from the arcs
+    const double rotation = fabs(angles::shortest_angular_distance(from->getYaw(), to->getYaw()));
+    unsigned int steps = 1;
+    if( (rotation > 0.0) && (circumscribed_radius_ > 0.5 * resolution) )
+    {
+      const double max_step_rotation = 2.0 * acos(1.0 - 0.5 * resolution / circumscribed_radius_);
+      steps = std::max(1u, (unsigned int) ceil(rotation / max_step_rotation));
+    }
+
+    ompl::base::State* work = si_->allocState();
+    si_->copyState(work, s1);
+    scratch.corners.clear();
+    addFootprintCorners(work, scratch);
+
+    double fraction = 1.0;
+    for(unsigned int i = 1; i <= steps; i++)
+    {
+      space->interpolate(s1, s2, (double) i / (double) steps, work);
+
+      // corners of the start pose of the sub-step are kept in the first half of the corners
+      scratch.corners.resize(footprint_.size());
+      addFootprintCorners(work, scratch);
+      computeConvexHull(scratch);
+
+      if(!checkHullCells(scratch, mask_min_x, mask_min_y, mask_size_x))
+      {
+        fraction = (double) (i - 1) / (double) steps;
+        break;
+      }
+
+      // end pose of this sub-step is the start pose of the next one
+      std::copy(scratch.corners.begin() + footprint_.size(), scratch.corners.end(), scratch.corners.begin());
+    }
+    si_->freeState(work);
+
+    return fraction;
+  }
+
+
+  bool SweptFootprintMotionValidator::checkMotion(const ompl::base::State* s1, const ompl::base::State* s2) const
+  {
+    // check end of motion with the state validity checker -> consistent with the checks of the sampled states
+    const bool result = si_->isValid(s2) && (checkSweptArea(s1, s2) == 1.0);
+
+    if(result)
+      valid_++;
+    else
+      invalid_++;
+
+    return result;
+  }
+
+
+  bool SweptFootprintMotionValidator::checkMotion(const ompl::base::State* s1, const ompl::base::State* s2,
+                                                  std::pair<ompl::base::State*, double>& last_valid) const
+  {
+    double fraction = checkSweptArea(s1, s2);
+    if( (fraction == 1.0) && si_->isValid(s2) )
+    {
+      valid_++;
+      return true;
+    }
+
+    // end of motion invalid -> only the swept area up to it is known to be valid, report start of motion
+    if(fraction == 1.0)
+      fraction = 0.0;
+
+    last_valid.second = fraction;
+    if(last_valid.first)
+      si_->getStateSpace()->interpolate(s1, s2, fraction, last_valid.first);
+    invalid_++;
+
+    return false;
+  }
+
+}
@@ -0,0 +1,190 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#include <ompl_planner_base/trace_buffer.h>
+
+// std c++ classes
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+
+namespace ompl_planner_base {
+
+  static unsigned int roundUpToPowerOfTwo(unsigned int value)
+  {
+    unsigned int result = 1;
+    while(result < value)
+      result *= 2;
+    return result;
+  }
+
+
+  TraceBuffer::TraceBuffer(unsigned int capacity)
+    : enabled_(false), capacity_(roundUpToPowerOfTwo(capacity)){}
+
+
+  bool TraceBuffer::setCapacity(unsigned int capacity)
+  {
+    boost::mutex::scoped_lock lock(buffers_mutex_);
+    if(!buffers_.empty())
+      return false;
+
+    capacity_ = roundUpToPowerOfTwo(capacity);
+    return true;
+  }
+
+
+  void TraceBuffer::setThreadName(const char* name)
+  {
+    getThreadBuffer().thread_name.store(name, boost::memory_order_relaxed);
+  }
+
+
+  void TraceBuffer::recordEvent(const char* name, Phase phase, boost::uint64_t timestamp, boost::int64_t value)
+  {
+    ThreadBuffer& buffer = getThreadBuffer();
+
+    // only this thread writes to the buffer -> plain load and store of the head
+    const boost::uint64_t head = buffer.head.load(boost::memory_order_relaxed);
+    Event& event = buffer.events[head & (buffer.events.size() - 1)];
+    event.timestamp = timestamp;
+    event.value = value;
+    event.name = name;
+    event.phase = (char) phase;
+    buffer.head.store(head + 1, boost::memory_order_release);
+  }
+
+
+  TraceBuffer::ThreadBuffer& TraceBuffer::getThreadBuffer()
+  {
+    ThreadHandle* handle = thread_handle_.get();
+    if(handle)
+      return *handle->buffer;
+
+    // first event of this thread -> take over the buffer of a finished thread or add a new one
+    boost::mutex::scoped_lock lock(buffers_mutex_);
+    boost::shared_ptr<ThreadBuffer> buffer;
+    for(unsigned int i = 0; (i < buffers_.size()) && !buffer; i++)
+    {
+      bool in_use = false;
+      if(buffers_[i]->in_use.compare_exchange_strong(in_use, true, boost::memory_order_acquire))
+        buffer = buffers_[i];
+    }
+
+    if(!buffer)
+    {
+      buffer = boost::shared_ptr<ThreadBuffer>(new ThreadBuffer());
+      buffer->events.resize(capacity_);
+      buffer->head.store(0, boost::memory_order_relaxed);
+      buffer->in_use.store(true, boost::memory_order_relaxed);
+      buffer->track = buffers_.size();
+      buffers_.push_back(buffer);
+    }
+    buffer->thread_name.store(NULL, boost::memory_order_relaxed);
+
+    handle = new ThreadHandle();
+    handle->buffer = buffer;
+    thread_handle_.reset(handle);
+    return *buffer;
+  }
+
+
+  void TraceBuffer::writeChromeTrace(std::ostream& stream) const
+  {
+    boost::mutex::scoped_lock lock(buffers_mutex_);
+
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    stream << std::fixed << std::setprecision(3);
+    bool first = true;
+    std::vector<Event> events;
+    for(unsigned int i = 0; i < buffers_.size(); i++)
+    {
+      const ThreadBuffer& buffer = *buffers_[i];
+      const boost::uint64_t capacity = buffer.events.size();
+
+      // copy the events, then drop all which may have been overwritten while copying
+      const boost::uint64_t head = buffer.head.load(boost::memory_order_acquire);
+      const boost::uint64_t begin = (head > capacity) ? head - capacity : 0;
+      events.resize(head - begin);
+      for(boost::uint64_t j = begin; j < head; j++)
+      {
+        events[j - begin] = buffer.events[j & (capacity - 1)];
+      }
+      boost::atomic_thread_fence(boost::memory_order_acquire);
+      const boost::uint64_t head_after = buffer.head.load(boost::memory_order_relaxed);
+      const boost::uint64_t valid_begin = (head_after >= capacity) ? head_after - capacity + 1 : 0;
+
+      const char* thread_name = buffer.thread_name.load(boost::memory_order_relaxed);
+      stream << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer.track
+             << ",\"args\":{\"name\":\"";
+      if(thread_name)
+        stream << thread_name;
+      else
+        stream << "thread " << buffer.track;
+      stream << "\"}}";
+      first = false;
+
+      for(boost::uint64_t j = std::max(begin, valid_begin); j < head; j++)
+      {
+        const Event& event = events[j - begin];
+        stream << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"" << event.phase << "\",\"pid\":1,\"tid\":" << buffer.track
+               << ",\"ts\":" << event.timestamp / 1000.0;
+        if(event.phase == COMPLETE)
+          stream << ",\"dur\":" << event.value / 1000.0;
+        else if(event.phase == COUNTER)
+          stream << ",\"args\":{\"value\":" << event.value << "}";
+        else if(event.phase == INSTANT)
+          stream << ",\"s\":\"t\"";
+        stream << "}";
+      }
+    }
+    stream << "\n]}\n";
+  }
+
+
+  bool TraceBuffer::dump(const std::string& file_name) const
+  {
+    std::ofstream file(file_name.c_str());
+    if(!file)
+      return false;
+
+    writeChromeTrace(file);
+    return file.good();
+  }
+
+}
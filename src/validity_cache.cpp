@@ -0,0 +1,198 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2010, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Christian Connette, Eitan Marder-Eppstein
+*********************************************************************/
+
+#include <ompl_planner_base/validity_cache.h>
+
+
+namespace ompl_planner_base {
+
+  // layout of an entry: [63] occupied, [62] valid, [46, 61] generation, [32, 45] yaw bin, [0, 31] cell index
+  static const boost::uint64_t OCCUPIED_BIT = 1ull << 63;
+  static const boost::uint64_t VALID_BIT = 1ull << 62;
+  static const unsigned int GENERATION_SHIFT = 46;
+  static const unsigned int GENERATION_MASK = 0xFFFF;
+  static const unsigned int YAW_BIN_SHIFT = 32;
+  static const boost::uint64_t KEY_MASK = ~(OCCUPIED_BIT | VALID_BIT);
+
+  // number of slots probed from the home slot of an entry
+  static const size_t NUM_PROBES = 8;
+
+
+  ValidityCache::ValidityCache() : capacity_(0), generation_(0){}
+
+
+  bool ValidityCache::allocate(size_t max_bytes)
+  {
+    size_t capacity = NUM_PROBES;
+    if(capacity * sizeof(boost::uint64_t) > max_bytes)
+    {
+      release();
+      return false;
+    }
+    while(2 * capacity * sizeof(boost::uint64_t) <= max_bytes)
+      capacity *= 2;
+
+    if(capacity != capacity_)
+    {
+      entries_.reset(new boost::atomic<boost::uint64_t>[capacity]);
+      capacity_ = capacity;
+    }
+
+    generation_ = 0;
+    for(size_t i = 0; i < capacity_; i++)
+      entries_[i].store(0, boost::memory_order_relaxed);
+
+    return true;
+  }
+
+
+  void ValidityCache::release()
+  {
+    entries_.reset();
+    capacity_ = 0;
+    generation_ = 0;
+  }
+
+
+  boost::uint64_t ValidityCache::makeKey(unsigned int cell_index, unsigned int yaw_bin) const
+  {
+    return ((boost::uint64_t) generation_ << GENERATION_SHIFT) | ((boost::uint64_t) yaw_bin << YAW_BIN_SHIFT) | cell_index;
+  }
+
+
+  size_t ValidityCache::homeSlot(unsigned int cell_index, unsigned int yaw_bin) const
+  {
+    // multiplicative hashing, neighbouring cells are spread over the table
+    const boost::uint64_t hash = (((boost::uint64_t) cell_index << 14) | yaw_bin) * 0x9E3779B97F4A7C15ull;
+    return (size_t) (hash >> 32) & (capacity_ - 1);
+  }
+
+
+  bool ValidityCache::lookup(unsigned int cell_index, unsigned int yaw_bin, bool& valid) const
+  {
+    if(capacity_ == 0)
+      return false;
+
+    const boost::uint64_t key = makeKey(cell_index, yaw_bin);
+    const size_t home = homeSlot(cell_index, yaw_bin);
+
+    // slots may have been emptied by region invalidation -> always probe the whole sequence
+    for(size_t i = 0; i < NUM_PROBES; i++)
+    {
+      const boost::uint64_t entry = entries_[(home + i) & (capacity_ - 1)].load(boost::memory_order_relaxed);
+      if( (entry & OCCUPIED_BIT) && ((entry & KEY_MASK) == key) )
+      {
+        valid = (entry & VALID_BIT) != 0;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+
+  void ValidityCache::insert(unsigned int cell_index, unsigned int yaw_bin, bool valid)
+  {
+    if(capacity_ == 0)
+      return;
+
+    const boost::uint64_t key = makeKey(cell_index, yaw_bin);
+    const size_t home = homeSlot(cell_index, yaw_bin);
+    const boost::uint64_t new_entry = OCCUPIED_BIT | (valid ? VALID_BIT : 0) | key;
+
+    // take the first slot holding the same key, or an empty or outdated one -> otherwise displace the entry in the home slot
+    size_t slot = home;
+    for(size_t i = 0; i < NUM_PROBES; i++)
+    {
+      const size_t probe = (home + i) & (capacity_ - 1);
+      const boost::uint64_t entry = entries_[probe].load(boost::memory_order_relaxed);
+      const unsigned int entry_generation = (unsigned int) ((entry & KEY_MASK) >> GENERATION_SHIFT) & GENERATION_MASK;
+      if( !(entry & OCCUPIED_BIT) || (entry_generation != generation_) || ((entry & KEY_MASK) == key) )
+      {
+        slot = probe;
+        break;
+      }
+    }
+
+    // entries are self contained -> concurrent writes to one slot only lose one of the results
+    entries_[slot].store(new_entry, boost::memory_order_relaxed);
+  }
+
+
+  void ValidityCache::invalidate()
+  {
+    if(capacity_ == 0)
+      return;
+
+    generation_ = (generation_ + 1) & GENERATION_MASK;
+
+    // generation wrapped around -> entries of the old generation with this number would become valid again
+    if(generation_ == 0)
+    {
+      for(size_t i = 0; i < capacity_; i++)
+        entries_[i].store(0, boost::memory_order_relaxed);
+    }
+  }
+
+
+  unsigned int ValidityCache::invalidateRegion(unsigned int size_x, unsigned int min_x, unsigned int min_y,
+                                               unsigned int max_x, unsigned int max_y)
+  {
+    if( (capacity_ == 0) || (size_x == 0) )
+      return 0;
+
+    unsigned int num_dropped = 0;
+    for(size_t i = 0; i < capacity_; i++)
+    {
+      const boost::uint64_t entry = entries_[i].load(boost::memory_order_relaxed);
+      if(!(entry & OCCUPIED_BIT))
+        continue;
+
+      const unsigned int cell_index = (unsigned int) (entry & 0xFFFFFFFFull);
+      const unsigned int cell_x = cell_index % size_x;
+      const unsigned int cell_y = cell_index / size_x;
+      if( (cell_x >= min_x) && (cell_x <= max_x) && (cell_y >= min_y) && (cell_y <= max_y) )
+      {
+        entries_[i].store(0, boost::memory_order_relaxed);
+        num_dropped++;
+      }
+    }
+
+    return num_dropped;
+  }
+
+}